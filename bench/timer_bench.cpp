@@ -0,0 +1,667 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "base_timer.hpp"
+#include "high_res_timer.hpp"
+#include "live_stats.hpp"
+#include "multi_core_engine.hpp"
+#include "quantile_select.hpp"
+#include "realtime.hpp"
+#include "sample_stats.hpp"
+#include "spin_wait.hpp"
+#include "utils.hpp"
+
+namespace {
+
+/** @brief Keep the compiler from discarding a computed value */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief BaseTimer with its recording and output hooks opened up, so that
+ * they can be driven without running a timing loop
+ */
+class BenchTimer : public ts::BaseTimer {
+public:
+    BenchTimer() : BaseTimer(0.001, "us", 1000) {}
+
+    using BaseTimer::beginRecording;
+    using BaseTimer::enqueueOutput;
+    using BaseTimer::recordInterval;
+    using BaseTimer::startOutputThread;
+    using BaseTimer::stopOutputThreadAndJoin;
+};
+
+/**
+ * @brief Points file descriptor 1 at the null device for the lifetime of
+ * the guard
+ *
+ * The output thread writes tick lines straight to the descriptor,
+ * bypassing std::cout, so redirecting its streambuf would not keep them
+ * out of a report written to stdout.
+ */
+class StdoutSilencer {
+public:
+    StdoutSilencer() {
+        std::cout.flush();
+#ifdef _WIN32
+        saved_   = _dup(1);
+        int null = _open("NUL", _O_WRONLY);
+        if (saved_ < 0 || null < 0 || _dup2(null, 1) != 0) {
+            throw std::runtime_error("Failed to silence stdout");
+        }
+        _close(null);
+#else
+        saved_   = ::dup(STDOUT_FILENO);
+        int null = ::open("/dev/null", O_WRONLY);
+        if (saved_ < 0 || null < 0 || ::dup2(null, STDOUT_FILENO) < 0) {
+            throw std::runtime_error("Failed to silence stdout");
+        }
+        ::close(null);
+#endif
+    }
+
+    ~StdoutSilencer() {
+        std::cout.flush();
+#ifdef _WIN32
+        _dup2(saved_, 1);
+        _close(saved_);
+#else
+        ::dup2(saved_, STDOUT_FILENO);
+        ::close(saved_);
+#endif
+    }
+
+    StdoutSilencer(const StdoutSilencer&)            = delete;
+    StdoutSilencer& operator=(const StdoutSilencer&) = delete;
+
+private:
+    int saved_ = -1;
+};
+
+/**
+ * @brief One benchmark: a sample per repetition plus the summary written
+ * to the report
+ */
+struct Result {
+    std::string name;
+    std::string unit;
+    std::vector<double> samples;
+    std::uint64_t items = 0;  ///< Operations or inputs behind each sample
+};
+
+struct Settings {
+    int repetitions        = 10;
+    std::size_t maxSamples = 100000000;
+    int sleepWakeups       = 200;
+    std::string outputPath;  ///< Empty writes the report to stdout
+};
+
+using SteadyClock = std::chrono::steady_clock;
+
+double elapsedNs(SteadyClock::time_point start, SteadyClock::time_point end) {
+    return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/** @brief Per-call cost of a clock read, one sample per repetition */
+template <typename ReadClock>
+Result benchClockRead(const std::string& name, const Settings& settings,
+                      ReadClock&& read) {
+    constexpr std::size_t kCalls = 1000000;
+
+    Result result{name, "ns/op", {}, kCalls};
+    for (int rep = 0; rep < settings.repetitions; ++rep) {
+        auto start = SteadyClock::now();
+        for (std::size_t i = 0; i < kCalls; ++i) {
+            doNotOptimize(read());
+        }
+        auto end = SteadyClock::now();
+        result.samples.push_back(elapsedNs(start, end) / kCalls);
+    }
+    return result;
+}
+
+/**
+ * @brief Per-tick cost of publishing live statistics, for simulated 100us
+ * ticks with a 1s window, so that slice ends are amortized as in a run
+ */
+Result benchLiveStats(const Settings& settings) {
+    constexpr std::size_t kTicks       = 1000000;
+    constexpr std::int64_t kIntervalNs = 100000;
+
+    ts::LiveStatsPublisher publisher("timer_bench_live",
+                                     std::chrono::seconds(1));
+    Result result{"liveStats/record", "ns/op", {}, kTicks};
+    for (int rep = 0; rep < settings.repetitions; ++rep) {
+        publisher.begin("steady_clock", "us", kIntervalNs);
+        publisher.start(0);
+        auto start = SteadyClock::now();
+        for (std::size_t i = 1; i <= kTicks; ++i) {
+            std::int64_t jitter = static_cast<std::int64_t>(i % 7) * 100;
+            publisher.record(static_cast<std::int64_t>(i) * kIntervalNs +
+                                 jitter,
+                             kIntervalNs + jitter, jitter);
+        }
+        auto end = SteadyClock::now();
+        publisher.end();
+        result.samples.push_back(elapsedNs(start, end) / kTicks);
+    }
+    return result;
+}
+
+/**
+ * @brief Per-call cost of enqueueOutput in each queue state
+ * @param consumer Start the output thread (printing to the null device)
+ * @param prefill Fill the queue first so that every call takes the drop
+ * path
+ */
+Result benchEnqueue(const std::string& name, const Settings& settings,
+                    bool tickOutput, bool consumer, bool prefill) {
+    // Fits the output queue, so without a consumer nothing is dropped
+    constexpr std::size_t kCalls = 16000;
+
+    const ts::BaseTimer::OutputData data{
+        ts::BaseTimer::OutputData::Type::Interval, 1707280123456000000,
+        1000000};
+
+    Result result{name, "ns/op", {}, kCalls};
+    for (int rep = 0; rep < settings.repetitions; ++rep) {
+        BenchTimer timer;
+        timer.setTickOutput(tickOutput);
+        if (prefill) {
+            for (std::size_t i = 0; i < 2 * kCalls; ++i) {
+                timer.enqueueOutput(data);
+            }
+        }
+        if (consumer) {
+            timer.startOutputThread();
+        }
+
+        auto start = SteadyClock::now();
+        for (std::size_t i = 0; i < kCalls; ++i) {
+            timer.enqueueOutput(data);
+        }
+        auto end = SteadyClock::now();
+
+        if (consumer) {
+            timer.stopOutputThreadAndJoin();
+        }
+        result.samples.push_back(elapsedNs(start, end) / kCalls);
+    }
+    return result;
+}
+
+/** @brief Wake-up lateness of sleep_until at several sleep lengths */
+Result benchSleepLateness(std::chrono::microseconds sleepFor,
+                          const Settings& settings) {
+    Result result{"sleep_until/lateness/" + std::to_string(sleepFor.count()) +
+                      "us",
+                  "ns",
+                  {},
+                  static_cast<std::uint64_t>(settings.sleepWakeups)};
+    result.samples.reserve(static_cast<std::size_t>(settings.sleepWakeups));
+    for (int i = 0; i < settings.sleepWakeups; ++i) {
+        auto deadline = SteadyClock::now() + sleepFor;
+        std::this_thread::sleep_until(deadline);
+        result.samples.push_back(elapsedNs(deadline, SteadyClock::now()));
+    }
+    return result;
+}
+
+/**
+ * @brief Two CPUs sharing a physical core (SMT siblings), or {-1, -1} if
+ * there are none or the topology is unknown
+ */
+std::pair<int, int> findSmtSiblings() {
+    unsigned int cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int cpu = 0; cpu < cpus; ++cpu) {
+        std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                         "/topology/thread_siblings_list");
+        std::string list;
+        if (!std::getline(in, list)) {
+            continue;
+        }
+        try {
+            std::vector<int> siblings = ts::parseCpuList(list);
+            if (siblings.size() >= 2) {
+                return {siblings[0], siblings[1]};
+            }
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return {-1, -1};
+}
+
+/**
+ * @brief Busy-wait lateness under a spin policy, and the throughput of an
+ * integer workload running on the SMT sibling meanwhile
+ * @param policy Spin policy of the 100us waits; none keeps the timing
+ * thread asleep, giving the sibling's unloaded throughput
+ * @param cpus Timing and sibling CPUs, unpinned if negative
+ * @return The lateness result (absent without a policy) and the sibling
+ * throughput result
+ */
+std::vector<Result> benchSpinPolicy(const std::string& name,
+                                    std::optional<ts::SpinPolicy> policy,
+                                    std::pair<int, int> cpus,
+                                    const ts::ClockSource& clock,
+                                    const Settings& settings) {
+    constexpr auto kWait = std::chrono::microseconds(100);
+    auto wakeups         = static_cast<std::size_t>(settings.sleepWakeups);
+
+    Result lateness{"spin_policy/" + name + "/lateness/100us", "ns", {},
+                    wakeups};
+    Result sibling{"spin_policy/" + name + "/sibling_throughput", "Mops/s",
+                   {}, 0};
+
+    for (int rep = 0; rep < settings.repetitions; ++rep) {
+        std::atomic<bool> stop{false};
+        std::atomic<std::uint64_t> siblingOps{0};
+        std::string siblingPinError;
+        std::string timingPinError;
+
+        std::thread siblingThread([&] {
+            if (cpus.second >= 0) {
+                ts::pinCurrentThread(cpus.second, siblingPinError);
+            }
+            std::uint64_t x   = 88172645463325252ULL;
+            std::uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 1024; ++i) {
+                    x ^= x << 13;
+                    x ^= x >> 7;
+                    x ^= x << 17;
+                }
+                ops += 1024;
+            }
+            doNotOptimize(x);
+            siblingOps.store(ops, std::memory_order_relaxed);
+        });
+
+        auto start = SteadyClock::now();
+        std::thread timingThread([&] {
+            if (cpus.first >= 0) {
+                ts::pinCurrentThread(cpus.first, timingPinError);
+            }
+            if (!policy) {
+                std::this_thread::sleep_for(kWait * wakeups);
+                return;
+            }
+            ts::BusySpinWait wait(kWait);
+            wait.setSpinPolicy(*policy);
+            auto last = clock.now();
+            for (std::size_t i = 0; i < wakeups; ++i) {
+                auto deadline = clock.now() + kWait;
+                last          = wait.waitUntil(clock, last, deadline, false);
+                lateness.samples.push_back(elapsedNs(deadline, last));
+            }
+        });
+        timingThread.join();
+        stop.store(true, std::memory_order_relaxed);
+        siblingThread.join();
+        auto end = SteadyClock::now();
+
+        std::uint64_t ops = siblingOps.load(std::memory_order_relaxed);
+        sibling.items     = ops;
+        sibling.samples.push_back(static_cast<double>(ops) /
+                                  (elapsedNs(start, end) * 1e-3));
+    }
+
+    std::vector<Result> results;
+    if (policy) {
+        results.push_back(std::move(lateness));
+    }
+    results.push_back(std::move(sibling));
+    return results;
+}
+
+/** @brief Interval-like samples: 1ms with a little noise and rare outliers */
+std::vector<std::int64_t> makeIntervals(std::size_t count) {
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> noise(1e6, 2e3);
+    std::vector<std::int64_t> samples(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        double value = noise(rng);
+        if (i % 10007 == 0) {
+            value *= 3.0;
+        }
+        samples[i] = static_cast<std::int64_t>(std::max(value, 0.0));
+    }
+    return samples;
+}
+
+int repetitionsFor(std::size_t samples, const Settings& settings) {
+    // Keep the large sizes to a few seconds each
+    if (samples >= 10000000) return std::min(settings.repetitions, 3);
+    return settings.repetitions;
+}
+
+/**
+ * @brief Samples per second through the recording path: recordInterval()
+ * for every sample, then calculateStatistics()
+ */
+Result benchCalculateStatistics(const std::vector<std::int64_t>& intervals,
+                                std::size_t count, const Settings& settings) {
+    Result result{"calculateStatistics/" + std::to_string(count), "samples/s",
+                  {}, count};
+    BenchTimer timer;
+    timer.setRawCaptureLimit(0);
+    for (int rep = 0; rep < repetitionsFor(count, settings); ++rep) {
+        auto start = SteadyClock::now();
+        timer.beginRecording(count, "none");
+        for (std::size_t i = 0; i < count; ++i) {
+            timer.recordInterval(intervals[i]);
+        }
+        auto stats = timer.calculateStatistics();
+        doNotOptimize(stats.p9999);
+        auto end = SteadyClock::now();
+        result.samples.push_back(count / (elapsedNs(start, end) * 1e-9));
+    }
+    return result;
+}
+
+/**
+ * @brief Samples per second through the sort-based path: sort a copy, then
+ * calculatePercentile() for each reported percentile
+ */
+Result benchCalculatePercentile(const std::vector<std::int64_t>& intervals,
+                                std::size_t count, const Settings& settings) {
+    Result result{"calculatePercentile/" + std::to_string(count), "samples/s",
+                  {}, count};
+    std::vector<double> sorted(count);
+    for (int rep = 0; rep < repetitionsFor(count, settings); ++rep) {
+        auto start = SteadyClock::now();
+        for (std::size_t i = 0; i < count; ++i) {
+            sorted[i] = static_cast<double>(intervals[i]) / 1e3;
+        }
+        std::sort(sorted.begin(), sorted.end());
+        for (double p : {0.50, 0.75, 0.90, 0.95, 0.99, 0.999, 0.9999}) {
+            doNotOptimize(utils::calculatePercentile(sorted, p));
+        }
+        auto end = SteadyClock::now();
+        result.samples.push_back(count / (elapsedNs(start, end) * 1e-9));
+    }
+    return result;
+}
+
+/**
+ * @brief Samples per second through the selection-based path:
+ * QuantileSelector::select() for every reported percentile at once, on the
+ * sequential path or, from QuantileSelector::kParallelThreshold samples,
+ * the parallel one
+ */
+Result benchSelectPercentiles(const std::vector<std::int64_t>& intervals,
+                              std::size_t count, const Settings& settings) {
+    static constexpr double kFractions[] = {0.50, 0.75,  0.90,  0.95,
+                                            0.99, 0.999, 0.9999};
+    Result result{"selectPercentiles/" + std::to_string(count), "samples/s",
+                  {}, count};
+    ts::QuantileSelector selector;
+    std::int64_t values[std::size(kFractions)];
+    for (int rep = 0; rep < repetitionsFor(count, settings); ++rep) {
+        auto start = SteadyClock::now();
+        selector.select(intervals.data(), count, kFractions,
+                        std::size(kFractions), values);
+        doNotOptimize(values[std::size(kFractions) - 1]);
+        auto end = SteadyClock::now();
+        result.samples.push_back(count / (elapsedNs(start, end) * 1e-9));
+    }
+    return result;
+}
+
+/**
+ * @brief Samples per second through summarizeSamples(), the single pass
+ * behind stddev, min, max, mean absolute deviation and jitter
+ */
+Result benchSummarizeSamples(const std::vector<std::int64_t>& intervals,
+                             std::size_t count, const Settings& settings) {
+    Result result{std::string("summarizeSamples/") + ts::sampleKernelName() +
+                      "/" + std::to_string(count),
+                  "samples/s", {}, count};
+    for (int rep = 0; rep < repetitionsFor(count, settings); ++rep) {
+        auto start = SteadyClock::now();
+        ts::SampleSummary summary =
+            ts::summarizeSamples(intervals.data(), count, 1000000);
+        doNotOptimize(summary.maxJitter);
+        auto end = SteadyClock::now();
+        result.samples.push_back(count / (elapsedNs(start, end) * 1e-9));
+    }
+    return result;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(std::ostream& out, const std::vector<Result>& results,
+               const Settings& settings, const std::string& clockSource,
+               std::pair<int, int> smtSiblings) {
+    auto now = std::chrono::system_clock::now();
+
+    out << std::setprecision(6);
+    out << "{\n"
+        << "  \"suite\": \"timer_bench\",\n"
+        << "  \"timestamp_ms\": " << utils::toMilliseconds(now) << ",\n"
+        << "  \"context\": {\n"
+        << "    \"hardware_concurrency\": "
+        << std::thread::hardware_concurrency() << ",\n"
+        << "    \"high_res_clock\": \"" << jsonEscape(clockSource) << "\",\n"
+        << "    \"spin_policy_cpus\": [" << smtSiblings.first << ", "
+        << smtSiblings.second << "],\n"
+        << "    \"repetitions\": " << settings.repetitions << "\n"
+        << "  },\n"
+        << "  \"benchmarks\": [\n";
+
+    for (std::size_t r = 0; r < results.size(); ++r) {
+        std::vector<double> sorted = results[r].samples;
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (double v : sorted) sum += v;
+        double mean     = sum / sorted.size();
+        double variance = 0.0;
+        for (double v : sorted) variance += (v - mean) * (v - mean);
+        double stddev =
+            sorted.size() > 1 ? std::sqrt(variance / (sorted.size() - 1)) : 0;
+
+        out << "    {\"name\": \"" << jsonEscape(results[r].name)
+            << "\", \"unit\": \"" << results[r].unit
+            << "\", \"items\": " << results[r].items
+            << ", \"samples\": " << sorted.size()
+            << ", \"min\": " << sorted.front()
+            << ", \"median\": " << utils::calculatePercentile(sorted, 0.5)
+            << ", \"mean\": " << mean << ", \"stddev\": " << stddev
+            << ", \"p99\": " << utils::calculatePercentile(sorted, 0.99)
+            << ", \"max\": " << sorted.back() << "}"
+            << (r + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}\n";
+}
+
+void printUsage(const char* programName) {
+    std::cerr << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  --repetitions <n>    Repetitions per benchmark "
+                 "(default: 10)\n"
+              << "  --max-samples <n>    Largest statistics input size "
+                 "(default: 100000000)\n"
+              << "  --wakeups <n>        Wake-ups per sleep_until benchmark "
+                 "(default: 200)\n"
+              << "  --output <file>      Write the JSON report to a file "
+                 "instead of stdout\n";
+}
+
+Settings parseSettings(int argc, char* argv[]) {
+    Settings settings;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value      = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+        auto positive = [&](const std::string& text) {
+            std::istringstream iss(text);
+            double number = 0;
+            iss >> number;
+            if (iss.fail() || !iss.eof() || number < 1) {
+                throw std::invalid_argument("Invalid value for " + arg +
+                                            ": " + text);
+            }
+            return number;
+        };
+
+        if (arg == "--repetitions") {
+            settings.repetitions = static_cast<int>(positive(value()));
+        } else if (arg == "--max-samples") {
+            settings.maxSamples = static_cast<std::size_t>(positive(value()));
+        } else if (arg == "--wakeups") {
+            settings.sleepWakeups = static_cast<int>(positive(value()));
+        } else if (arg == "--output") {
+            settings.outputPath = value();
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    return settings;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    Settings settings;
+    try {
+        settings = parseSettings(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        std::vector<Result> results;
+        auto progress = [](const Result& result) {
+            std::cerr << "  " << result.name << "\n";
+        };
+        auto add = [&](Result result) {
+            progress(result);
+            results.push_back(std::move(result));
+        };
+
+        ts::HighResTimer highRes(0.0001);
+        std::string clockSource = highRes.clock().describe();
+
+        add(benchClockRead("clock/system_clock::now", settings,
+                           [] { return std::chrono::system_clock::now(); }));
+        add(benchClockRead("clock/steady_clock::now", settings,
+                           [] { return SteadyClock::now(); }));
+        add(benchClockRead("clock/HighResTimer::now", settings,
+                           [&] { return highRes.now(); }));
+
+        {
+            // The consumer prints every record; keep that out of the report
+            StdoutSilencer silencer;
+            add(benchEnqueue("enqueueOutput/disabled", settings, false,
+                             false, false));
+            add(benchEnqueue("enqueueOutput/no_consumer", settings, true,
+                             false, false));
+            add(benchEnqueue("enqueueOutput/no_consumer_full", settings, true,
+                             false, true));
+            add(benchEnqueue("enqueueOutput/consumer", settings, true, true,
+                             false));
+        }
+        add(benchLiveStats(settings));
+
+        for (auto sleepFor : {std::chrono::microseconds(100),
+                              std::chrono::microseconds(1000)}) {
+            add(benchSleepLateness(sleepFor, settings));
+        }
+
+        // The sibling workload shares a physical core with the spinning
+        // thread when the topology allows; otherwise both float
+        std::pair<int, int> smtSiblings = findSmtSiblings();
+        for (Result& result :
+             benchSpinPolicy("none", std::nullopt, smtSiblings,
+                             highRes.clock(), settings)) {
+            add(std::move(result));
+        }
+        std::vector<ts::SpinPolicy> policies = {
+            ts::SpinPolicy::Raw, ts::SpinPolicy::Pause, ts::SpinPolicy::Yield};
+        if (ts::cpuHasWaitpkg()) {
+            policies.push_back(ts::SpinPolicy::Tpause);
+        }
+        for (ts::SpinPolicy policy : policies) {
+            for (Result& result :
+                 benchSpinPolicy(ts::spinPolicyName(policy), policy,
+                                 smtSiblings, highRes.clock(), settings)) {
+                add(std::move(result));
+            }
+        }
+
+        std::vector<std::int64_t> intervals = makeIntervals(
+            std::min<std::size_t>(settings.maxSamples, 100000000));
+        for (std::size_t count = 100; count <= intervals.size();
+             count *= 10) {
+            add(benchCalculateStatistics(intervals, count, settings));
+            add(benchCalculatePercentile(intervals, count, settings));
+            add(benchSelectPercentiles(intervals, count, settings));
+            add(benchSummarizeSamples(intervals, count, settings));
+        }
+
+        if (settings.outputPath.empty()) {
+            writeJson(std::cout, results, settings, clockSource,
+                      smtSiblings);
+        } else {
+            std::ofstream out(settings.outputPath);
+            if (!out) {
+                throw std::runtime_error("Failed to open output file: " +
+                                         settings.outputPath);
+            }
+            writeJson(out, results, settings, clockSource, smtSiblings);
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,29 +1,61 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <condition_variable>
 #include <cstddef>
-#include <mutex>
-#include <queue>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "capture.hpp"
+#include "histogram.hpp"
+#include "live_stats.hpp"
+#include "overrun_policy.hpp"
+#include "quantile_select.hpp"
+#include "realtime.hpp"
+#include "run_arena.hpp"
+#include "soak.hpp"
+#include "spsc_ring.hpp"
+#include "tick_trace.hpp"
 #include "utils.hpp"
 
 namespace ts {
 
+/**
+ * @brief Raises the timer resolution and thread priority on Windows for the
+ * lifetime of the guard; does nothing elsewhere
+ */
+class PlatformTimingGuard {
+public:
+    explicit PlatformTimingGuard(bool highestPriority);
+    ~PlatformTimingGuard();
+
+    PlatformTimingGuard(const PlatformTimingGuard&)            = delete;
+    PlatformTimingGuard& operator=(const PlatformTimingGuard&) = delete;
+};
+
+/**
+ * @brief Recording, output and reporting shared by every BasicTimer
+ * specialization
+ *
+ * Holds no virtual functions: the timing loop lives in the BasicTimer
+ * template, and the hot path only deals in integer nanoseconds. Conversion
+ * to the display unit happens in the output thread and at report time.
+ */
 class BaseTimer {
 public:
     struct OutputData {
         enum class Type { Start, Interval };
         Type type;
-        long long timestamp;
-        double realInterval;
+        std::int64_t timestampNs;  ///< Since the clock's epoch
+        std::int64_t intervalNs;
     };
 
-    explicit BaseTimer(double intervalSec, const std::string& unit);
-    virtual ~BaseTimer();
+    /** @brief Default cap on raw samples kept in getIntervals() */
+    static constexpr std::size_t kDefaultRawCaptureLimit = 1000000;
 
     // Disable copying and moving
     BaseTimer(const BaseTimer&)            = delete;
@@ -31,33 +63,365 @@ public:
     BaseTimer(BaseTimer&&)                 = delete;
     BaseTimer& operator=(BaseTimer&&)      = delete;
 
-    virtual void run(std::size_t iterations = 100) = 0;
-
+    /**
+     * @brief Build statistics of the last run
+     *
+     * Percentiles are exact, selected from the raw intervals, when the raw
+     * capture holds every sample, and read from the interval histogram
+     * otherwise.
+     * @throws std::runtime_error if no intervals were collected
+     */
     ::utils::TimingStats calculateStatistics() const;
 
-    void printStatistics(const ::utils::TimingStats& stats) const;
+    /**
+     * @brief Interval at an arbitrary percentile of the last run, exact
+     * under the same condition as calculateStatistics()
+     * @param p Percentile fraction (0.0 to 1.0), e.g. 0.999 for p99.9
+     * @return The interval in the timer's unit
+     */
+    double percentile(double p) const;
 
-    const std::vector<double>& getIntervals() const {
+    /**
+     * @brief Raw intervals of the last run, in nanoseconds
+     *
+     * Only the first getRawCaptureLimit() samples are kept so that memory
+     * stays bounded on long runs; statistics always cover every sample.
+     */
+    const ArenaVector<std::int64_t>& getIntervals() const {
         return intervals_;
     }
 
+    const LatencyHistogram& getHistogram() const {
+        return histogram_;
+    }
+
+    /**
+     * @brief Lateness of every tick of the last run against its deadline,
+     * in nanoseconds
+     */
+    const LatencyHistogram& getLatenessHistogram() const {
+        return latenessHistogram_;
+    }
+
+    /**
+     * @brief Limit how many raw samples are kept for getIntervals() and the
+     * raw data section of the log (0 disables raw capture)
+     */
+    void setRawCaptureLimit(std::size_t limit) {
+        rawCaptureLimit_ = limit;
+    }
+
+    std::size_t getRawCaptureLimit() const {
+        return rawCaptureLimit_;
+    }
+
+    /**
+     * @brief Stream raw intervals into a binary capture file instead of
+     * keeping them in memory and dumping them as text (empty disables)
+     */
+    void setCapturePath(const std::string& path) {
+        capturePath_ = path;
+    }
+
+    /**
+     * @brief Enable or disable the per-tick console output; when disabled no
+     * output thread is started
+     */
+    void setTickOutput(bool enabled) {
+        tickOutput_    = enabled;
+        outputEnabled_ = tickOutput_ || soak_;
+    }
+
+    /**
+     * @brief Log windowed statistics while the timer runs (empty disables).
+     * The windows are fed by the output thread, which runs for them even
+     * with tick output disabled.
+     */
+    void setSoakWindows(const std::vector<SoakWindow>& windows);
+
+    /**
+     * @brief Publish running statistics into a shared-memory segment while
+     * the timer runs, for timer-top (empty name disables)
+     * @param name Segment name
+     * @param window Length of the rolling percentile window
+     * @throws std::runtime_error if the segment cannot be created
+     */
+    void setLiveStats(const std::string& name,
+                      std::chrono::nanoseconds window);
+
+    /**
+     * @brief Place the raw samples, output queue, output buffer and tick
+     * trace of every subsequent run in a prefaulted, locked RunArena
+     * (disabled by default)
+     *
+     * The arena is sized and faulted in by run() before the timing loop
+     * starts, and reused by later runs that fit in it.
+     */
+    void setRunArena(const RunArenaOptions& options);
+
+    /** @brief Arena of the last run, or nullptr if it ran without one */
+    const RunArena* getRunArena() const {
+        return arena_.get();
+    }
+
+    /**
+     * @brief Page faults the timing thread took inside the timing loop of
+     * the last run
+     */
+    const PageFaults& getRunPageFaults() const {
+        return runFaults_;
+    }
+
+    /** @brief Choose what run() does after a tick overran later deadlines */
+    void setOverrunPolicy(OverrunPolicy policy) {
+        overrunPolicy_ = policy;
+    }
+
+    OverrunPolicy getOverrunPolicy() const {
+        return overrunPolicy_;
+    }
+
+    /**
+     * @brief Keep catch-up ticks out of the interval histogram, the raw
+     * intervals and the capture, and record them in getCatchUpHistogram()
+     * instead; only catch-up produces them
+     */
+    void setExcludeCatchUp(bool exclude);
+
+    /** @brief Deadline overruns of the last run */
+    const OverrunStats& getOverrunStats() const {
+        return overrunStats_;
+    }
+
+    /**
+     * @brief Intervals of the catch-up ticks of the last run, in
+     * nanoseconds, or nullptr if they are not excluded from the statistics
+     */
+    const LatencyHistogram* getCatchUpHistogram() const {
+        return catchUpHistogram_.get();
+    }
+
+    /**
+     * @brief Make a running (or the next) run() return after the current
+     * tick; async-signal-safe, so it may be called from a signal handler
+     */
+    void requestStop() {
+        stopRequested_.store(true, std::memory_order_relaxed);
+    }
+
+#ifdef TS_ENABLE_TRACE
+    /** @brief Per-tick phase trace of the last run */
+    const TickTrace& getTrace() const {
+        return trace_;
+    }
+
+    /**
+     * @brief Write the last run's tick trace as Chrome trace JSON
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void writeTrace(const std::string& path) const {
+        trace_.writeChromeTrace(path, clockName_);
+    }
+#endif
+
+    std::chrono::nanoseconds getInterval() const {
+        return interval_;
+    }
+
+    /** @brief First timestamp of the last run, in the steady_clock epoch */
+    std::int64_t getStartSteadyTime() const {
+        return startSteadyNs_;
+    }
+
+    const char* getUnit() const {
+        return unit_;
+    }
+
+    double getNanosecondsPerUnit() const {
+        return nanosecondsPerUnit_;
+    }
+
+    /** @brief Configure Linux real-time mode for subsequent runs */
+    void setRealtimeOptions(const RealtimeOptions& options) {
+        realtime_ = options;
+    }
+
+    /** @brief Real-time steps applied and skipped during the last run */
+    const RealtimeReport& getRealtimeReport() const {
+        return realtimeReport_;
+    }
+
+    /**
+     * @brief Number of output records dropped because the output thread fell
+     * behind and the queue was full
+     */
+    std::uint64_t getDroppedOutputs() const {
+        return droppedOutputs_.load(std::memory_order_relaxed);
+    }
+
 protected:
+    BaseTimer(double intervalSec, const char* unit,
+              std::int64_t nanosecondsPerUnit);
+    ~BaseTimer();
+
     std::chrono::nanoseconds interval_;
-    std::vector<double> intervals_;
-    std::string unit_;
+    ArenaVector<std::int64_t> intervals_;
+    const char* unit_;
+    double nanosecondsPerUnit_;
+    LatencyHistogram histogram_;
+    LatencyHistogram latenessHistogram_;
+    RealtimeOptions realtime_;
+    RealtimeReport realtimeReport_;
+    std::atomic<bool> stopRequested_{false};
+#ifdef TS_ENABLE_TRACE
+    TickTrace trace_;
+    const char* clockName_ = "";
+#endif
+
+    /**
+     * @brief Clear the previous run and reserve raw capture storage, so that
+     * recordInterval() never allocates
+     * @param iterations Expected number of intervals, 0 if unbounded
+     * @param clockName Clock recorded in the capture header
+     */
+    void beginRecording(std::size_t iterations, const char* clockName);
+
+    /**
+     * @brief Record one measured interval (O(1), allocation free)
+     * @param intervalNs The measured interval; negative values count as 0
+     */
+    void recordInterval(std::int64_t intervalNs) {
+        std::int64_t ns = intervalNs < 0 ? 0 : intervalNs;
+        histogram_.record(static_cast<std::uint64_t>(ns));
+        if (intervals_.size() < rawCaptureSlots_) {
+            intervals_.push_back(ns);
+        }
+        if (capture_.isOpen()) {
+            capture_.append(ns);
+        }
+    }
+
+    /** @brief Record how late a tick woke up (O(1), allocation free) */
+    void recordLateness(std::int64_t latenessNs) {
+        latenessHistogram_.record(
+            static_cast<std::uint64_t>(latenessNs < 0 ? 0 : latenessNs));
+    }
+
+    /**
+     * @brief Record the interval of a tick fired for a deadline that the
+     * previous tick had already passed
+     */
+    void recordCatchUp(std::int64_t intervalNs) {
+        ++overrunStats_.catchUpTicks;
+        if (catchUpHistogram_) {
+            catchUpHistogram_->record(
+                static_cast<std::uint64_t>(intervalNs < 0 ? 0 : intervalNs));
+        } else {
+            recordInterval(intervalNs);
+        }
+    }
+
+    /**
+     * @brief Count a tick that woke past later deadlines and apply the
+     * overrun policy
+     * @param deadlineNs Deadline of the tick
+     * @param nowNs Timestamp of the tick, in the same epoch
+     * @return Nanoseconds to move the deadline grid forward by
+     */
+    std::int64_t handleOverrun(std::int64_t deadlineNs, std::int64_t nowNs) {
+        std::int64_t intervalNs = interval_.count();
+        if (intervalNs <= 0 || nowNs - deadlineNs < intervalNs) {
+            return 0;
+        }
+        return accountOverrun(deadlineNs, nowNs - deadlineNs);
+    }
+
+    /**
+     * @brief Publish one tick to the live statistics segment, if any
+     * @param latenessNs Timestamp of the tick minus its deadline
+     */
+    void publishLive(std::int64_t nowNs, std::int64_t intervalNs,
+                     std::int64_t latenessNs) {
+        if (live_) {
+            live_->record(nowNs, intervalNs, latenessNs);
+        }
+    }
+
+    /**
+     * @brief Note the first timestamp of the run for the capture header
+     * @param startTimeNs In the timer clock's epoch
+     * @param startSteadyNs The same instant in the steady_clock epoch
+     */
+    void markStart(std::int64_t startTimeNs, std::int64_t startSteadyNs) {
+        startSteadyNs_ = startSteadyNs;
+        if (capture_.isOpen()) {
+            capture_.setStartTime(startTimeNs);
+        }
+        if (live_) {
+            live_->start(startTimeNs);
+        }
+#ifdef TS_ENABLE_TRACE
+        trace_.setStart(startTimeNs);
+#endif
+        faultsAtStart_ = threadPageFaults();
+    }
+
+    /**
+     * @brief Finish the run's recording and close the capture file; called
+     * by the timing thread right after the loop
+     */
+    void endRecording();
+
+    /** @brief Log the statistics block */
+    void printStatisticsBlock(const ::utils::TimingStats& stats) const;
+
+    /**
+     * @brief Log the real-time report, dropped output count and the raw
+     * interval section; follows the timer-specific details
+     */
+    void printRunReport(const ::utils::TimingStats& stats) const;
 
     void startOutputThread();
     void stopOutputThreadAndJoin();
     void enqueueOutput(const OutputData& data);
 
 private:
+    static constexpr std::size_t kOutputQueueCapacity = 16384;
+    static constexpr std::size_t kOutputBufferBytes   = 64 * 1024;
+
     std::thread outputThread_;
-    std::queue<OutputData> outputQueue_;
-    std::mutex queueMutex_;
-    std::condition_variable queueCV_;
-    bool stopOutputThread_ = false;
+    // Rebuilt in place when the run buffers move in or out of the arena
+    std::optional<SpscRing<OutputData, ArenaAllocator<OutputData>>>
+        outputQueue_;
+    ArenaVector<char> outputBuffer_;  // Tick lines of one batch
+    std::atomic<bool> stopOutputThread_{false};
+    std::atomic<std::uint64_t> droppedOutputs_{0};
+    bool tickOutput_    = true;
+    bool outputEnabled_ = true;  // Tick output or soak windows; set with them
+    std::unique_ptr<SoakAggregator> soak_;
+    std::unique_ptr<LiveStatsPublisher> live_;
+    OverrunPolicy overrunPolicy_ = OverrunPolicy::CatchUp;
+    OverrunStats overrunStats_{};
+    std::int64_t missedThroughNs_ = INT64_MIN;  // Last deadline counted
+    std::unique_ptr<LatencyHistogram> catchUpHistogram_;
+    std::string outputPinError_;  // Written by the output thread before join
+    std::size_t rawCaptureLimit_ = kDefaultRawCaptureLimit;
+    mutable QuantileSelector selector_;  // Scratch kept across calls
+    std::size_t rawCaptureSlots_ = 0;
+    std::string capturePath_;
+    CaptureWriter capture_;
+    std::uint64_t capturedSamples_ = 0;
+    std::int64_t startSteadyNs_    = 0;
+    RunArenaOptions arenaOptions_;
+    bool rebuildArena_ = false;  // Options changed since the arena was made
+    std::unique_ptr<RunArena> arena_;
+    PageFaults faultsAtStart_;
+    PageFaults runFaults_;
 
     void outputWorker();
+    void placeRunBuffers(std::size_t traceTicks);
+    std::int64_t accountOverrun(std::int64_t deadlineNs,
+                                std::int64_t latenessNs);
 };
 
 }  // namespace ts
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "base_timer.hpp"
+#include "logger.hpp"
+#include "realtime.hpp"
+#include "timer_policies.hpp"
+
+namespace ts {
+
+/**
+ * @brief Periodic timer specialized at compile time on its clock, display
+ * unit and wait strategy
+ *
+ * run() waits for deadlines on a drift-free grid (previous deadline plus
+ * one interval) and records each measured interval as integer nanoseconds;
+ * no unit conversion, virtual call or string handling happens per tick.
+ * A tick that wakes past later deadlines moves the grid according to the
+ * overrun policy (see BaseTimer::setOverrunPolicy()).
+ * Timer and HighResTimer are the pre-instantiated specializations.
+ *
+ * @tparam Clock Clock policy: time_point, now(), resyncIfDue(), name(),
+ * describe()
+ * @tparam Unit Display unit: kLabel, kNanoseconds
+ * @tparam WaitStrategy Wait policy: begin(), waitUntil(), end(),
+ * setInterval(), printDetails(), kHighestPriority, kSleeps
+ */
+template <typename Clock, typename Unit, typename WaitStrategy>
+class BasicTimer : public BaseTimer {
+public:
+    using time_point = typename Clock::time_point;
+
+    static_assert(std::char_traits<char>::length(Unit::kLabel) <
+                      sizeof(CaptureHeader::unit),
+                  "Unit label must fit the capture header");
+
+    explicit BasicTimer(double intervalSec, Clock clock = Clock())
+        : BaseTimer(intervalSec, Unit::kLabel, Unit::kNanoseconds),
+          clock_(std::move(clock)),
+          wait_(interval_) {}
+
+    /**
+     * @brief Change the interval of subsequent runs, keeping every buffer,
+     * the clock and the wait strategy's settings
+     */
+    void setInterval(double intervalSec) {
+        interval_ = std::chrono::nanoseconds(
+            static_cast<long long>(intervalSec * 1e9));
+        wait_.setInterval(interval_);
+    }
+
+    /**
+     * @brief Run the timing loop
+     * @param iterations Intervals to measure; 0 runs until requestStop()
+     */
+    void run(std::size_t iterations = 100);
+
+    /** @brief Log the statistics followed by the run's details */
+    void printStatistics(const ::utils::TimingStats& stats) const {
+        printStatisticsBlock(stats);
+        wait_.printDetails();
+        std::string clockDescription = clock_.describe();
+        if (!clockDescription.empty()) {
+            logger << "Clock source: " << clockDescription << "\n";
+        }
+        printRunReport(stats);
+    }
+
+    /** @brief Read the clock the timer polls */
+    time_point now() const {
+        return clock_.now();
+    }
+
+    const Clock& clock() const {
+        return clock_;
+    }
+
+    WaitStrategy& waitStrategy() {
+        return wait_;
+    }
+
+    const WaitStrategy& waitStrategy() const {
+        return wait_;
+    }
+
+private:
+    using Deadline = std::chrono::time_point<typename time_point::clock,
+                                             std::chrono::nanoseconds>;
+
+    // The same instant in the steady_clock epoch; other clocks take one
+    // steady_clock read, so the two differ by the duration of a clock read
+    static std::int64_t steadyEpochNs(std::int64_t clockNs) {
+        if constexpr (std::is_same_v<typename time_point::clock,
+                                     std::chrono::steady_clock>) {
+            return clockNs;
+        } else {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+    }
+
+    static std::int64_t sinceEpochNs(time_point tp) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   tp.time_since_epoch())
+            .count();
+    }
+
+    Clock clock_;
+    WaitStrategy wait_;
+};
+
+template <typename Clock, typename Unit, typename WaitStrategy>
+void BasicTimer<Clock, Unit, WaitStrategy>::run(std::size_t iterations) {
+    beginRecording(iterations, clock_.name());
+
+    PlatformTimingGuard platformGuard(WaitStrategy::kHighestPriority);
+
+    // Start the output thread first so it does not inherit the timing
+    // thread's real-time policy and affinity
+    startOutputThread();
+    RealtimeGuard realtimeGuard(realtime_, realtimeReport_,
+                                WaitStrategy::kSleeps);
+
+    wait_.begin(clock_);
+
+    time_point last     = clock_.now();
+    std::int64_t lastNs = sinceEpochNs(last);
+    Deadline deadline   = std::chrono::time_point_cast<
+        std::chrono::nanoseconds>(last);
+    markStart(lastNs, steadyEpochNs(lastNs));
+    enqueueOutput({OutputData::Type::Start, lastNs, 0});
+
+    for (std::size_t i = 0; iterations == 0 || i < iterations; ++i) {
+        if (stopRequested_.load(std::memory_order_relaxed)) {
+            break;
+        }
+        deadline += interval_;
+        // Already passed by the previous tick, which overran it
+        const bool catchUp = deadline.time_since_epoch().count() <= lastNs;
+
+#ifdef TS_ENABLE_TRACE
+        TickPhases phases;
+        time_point now = wait_.waitUntil(clock_, last, deadline,
+                                         realtime_.enabled, phases);
+#else
+        time_point now =
+            wait_.waitUntil(clock_, last, deadline, realtime_.enabled);
+#endif
+        std::int64_t nowNs      = sinceEpochNs(now);
+        std::int64_t deadlineNs = deadline.time_since_epoch().count();
+
+        if (catchUp) {
+            recordCatchUp(nowNs - lastNs);
+        } else {
+            recordInterval(nowNs - lastNs);
+        }
+        recordLateness(nowNs - deadlineNs);
+        publishLive(nowNs, nowNs - lastNs, nowNs - deadlineNs);
+        enqueueOutput({OutputData::Type::Interval, nowNs, nowNs - lastNs});
+#ifdef TS_ENABLE_TRACE
+        trace_.record(deadlineNs, phases, nowNs,
+                      sinceEpochNs(clock_.now()) - nowNs);
+#endif
+        deadline += std::chrono::nanoseconds(handleOverrun(deadlineNs, nowNs));
+        last   = now;
+        lastNs = nowNs;
+        // Between ticks, so that no measured interval spans the resync
+        clock_.resyncIfDue(now);
+    }
+
+    wait_.end();
+    endRecording();
+    stopOutputThreadAndJoin();
+}
+
+}  // namespace ts
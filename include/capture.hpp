@@ -0,0 +1,167 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief On-disk header of a binary interval capture
+ *
+ * The header is followed by sampleCount fixed-width int64 samples, each the
+ * measured interval in nanoseconds. Header fields and samples are stored in
+ * the writing host's native byte order; a reader on a host of the other
+ * order rejects the file, since its version does not match.
+ */
+struct CaptureHeader {
+    static constexpr char kMagic[8] = {'T', 'S', 'C', 'A', 'P', 'T', 0, 0};
+    static constexpr std::uint32_t kVersion   = 1;
+    static constexpr std::uint32_t kFormatI64 = 1;  ///< int64 ns samples
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    char clockSource[32];  ///< e.g. "system_clock", "steady_clock", "tsc"
+    char unit[8];          ///< Display unit of the text layout, "ms" or "us"
+    double nanosecondsPerUnit;
+    std::int64_t intervalNs;   ///< Target interval
+    std::int64_t startTimeNs;  ///< First timestamp, in the clock's epoch
+    std::uint64_t sampleCount;
+    std::uint32_t sampleFormat;
+    std::uint32_t reserved;
+};
+
+static_assert(sizeof(CaptureHeader) == 96,
+              "CaptureHeader layout is part of the file format");
+
+/**
+ * @brief Streams interval samples into a pre-sized memory-mapped file
+ *
+ * open() sizes the file for the expected sample count, maps it and faults
+ * every page in, so append() is a single store with no formatting, no
+ * system call and no page fault. The file grows in fixed chunks mapped
+ * after the first: for an unbounded run a helper thread maps and prefaults
+ * the next chunk while the current one fills, so crossing into it only
+ * swaps pointers; a bounded run that outgrows its estimate maps the chunk
+ * on the spot. Chunks stay mapped until close(), which records the final
+ * sample count and trims the file. Platforms without mmap fall back to
+ * buffered stdio writes.
+ */
+class CaptureWriter {
+public:
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&)            = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * @brief Create the file and map room for expectedSamples samples
+     * @param path Output file path, truncated if it exists
+     * @param header Header template; magic, version, size, sample count and
+     * format are filled in by the writer
+     * @param expectedSamples Number of samples to pre-size for; 0 for a run
+     * of unknown length, which starts the chunk-mapping helper thread
+     * @throws std::runtime_error if the file cannot be created or mapped
+     */
+    void open(const std::string& path, const CaptureHeader& header,
+              std::size_t expectedSamples);
+
+    bool isOpen() const {
+        return open_;
+    }
+
+    /** @brief Set the start timestamp once it is known */
+    void setStartTime(std::int64_t startTimeNs);
+
+    /** @brief Append one sample (O(1), no formatting) */
+    void append(std::int64_t intervalNs) {
+        if (cursor_ == end_) {
+            grow();
+        }
+        *cursor_++ = intervalNs;
+    }
+
+    /** @brief Finalize the header and trim the file */
+    void close();
+
+    std::uint64_t sampleCount() const;
+
+    const std::string& path() const {
+        return path_;
+    }
+
+private:
+    /** @brief One mapped, prefaulted extent of the file */
+    struct Chunk {
+        void* base        = nullptr;
+        std::size_t bytes = 0;
+    };
+
+    void grow();
+    Chunk mapChunk(std::size_t offset, std::size_t bytes);
+    void extendLoop();
+    void stopExtender();
+    void unmap();
+
+    std::string path_;
+    bool open_             = false;
+    int fd_                = -1;
+    CaptureHeader* header_ = nullptr;
+    std::int64_t* samples_ = nullptr;  // First sample of the current chunk
+    std::int64_t* cursor_  = nullptr;
+    std::int64_t* end_     = nullptr;
+
+    // Every chunk mapped, and the file size they cover; the helper thread
+    // owns both while it runs
+    std::vector<Chunk> chunks_;
+    std::size_t mappedEnd_ = 0;
+
+    // Helper thread of unbounded runs: keeps one spare chunk ready
+    std::thread extender_;
+    std::mutex extendMutex_;
+    std::condition_variable extendWake_;
+    Chunk spare_;
+    bool stopExtending_ = false;
+    std::exception_ptr extendError_;
+
+    // Platforms without mmap stage samples in memory and write on grow/close
+    std::FILE* file_ = nullptr;
+    CaptureHeader fallbackHeader_{};
+    std::vector<std::int64_t> fallbackBuffer_;
+
+    // Samples before samples_: in earlier chunks, or already written by
+    // the stdio fallback
+    std::uint64_t flushedSamples_ = 0;
+};
+
+/**
+ * @brief A capture file loaded into memory
+ */
+struct Capture {
+    CaptureHeader header;
+    std::vector<std::int64_t> samples;
+};
+
+/**
+ * @brief Load and validate a capture file
+ * @throws std::runtime_error if the file is missing, truncated or not a
+ * capture
+ */
+Capture readCapture(const std::string& path);
+
+/**
+ * @brief Write samples in the text layout of the log file's raw interval
+ * section ("<index>: <interval>" in the capture's unit, two decimals)
+ */
+void writeCaptureAsText(const Capture& capture, std::ostream& out);
+
+}  // namespace ts
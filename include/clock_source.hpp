@@ -0,0 +1,209 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define TS_HAVE_TSC_CLOCK 1
+#include <x86intrin.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+namespace ts {
+
+namespace detail {
+
+#if defined(__GNUC__) || defined(__clang__)
+__extension__ typedef __int128 Int128;
+#endif
+
+/**
+ * @brief (a * b) >> 32 with a 128-bit intermediate, so that a 64-bit tick
+ * count times a 32.32 fixed-point factor cannot overflow
+ */
+inline std::int64_t mulShift32(std::int64_t a, std::int64_t b) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<std::int64_t>((static_cast<Int128>(a) * b) >> 32);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    std::int64_t high;
+    std::uint64_t low = static_cast<std::uint64_t>(_mul128(a, b, &high));
+    return static_cast<std::int64_t>(
+        (low >> 32) | (static_cast<std::uint64_t>(high) << 32));
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+    std::int64_t high = __mulh(a, b);
+    std::uint64_t low =
+        static_cast<std::uint64_t>(a) * static_cast<std::uint64_t>(b);
+    return static_cast<std::int64_t>(
+        (low >> 32) | (static_cast<std::uint64_t>(high) << 32));
+#else
+    // Magnitudes multiplied in 32-bit halves, then negated as 128 bits
+    auto magnitude = [](std::int64_t v) {
+        auto u = static_cast<std::uint64_t>(v);
+        return v < 0 ? 0 - u : u;
+    };
+    const bool negative    = (a < 0) != (b < 0);
+    const std::uint64_t ua = magnitude(a);
+    const std::uint64_t ub = magnitude(b);
+
+    std::uint64_t lowLow   = (ua & 0xffffffffu) * (ub & 0xffffffffu);
+    std::uint64_t highLow  = (ua >> 32) * (ub & 0xffffffffu);
+    std::uint64_t lowHigh  = (ua & 0xffffffffu) * (ub >> 32);
+    std::uint64_t highHigh = (ua >> 32) * (ub >> 32);
+    std::uint64_t middle   = (lowLow >> 32) + (highLow & 0xffffffffu) +
+                             (lowHigh & 0xffffffffu);
+    std::uint64_t low      = (middle << 32) | (lowLow & 0xffffffffu);
+    std::uint64_t high     = highHigh + (highLow >> 32) + (lowHigh >> 32) +
+                             (middle >> 32);
+    if (negative) {
+        low  = 0 - low;
+        high = ~high + (low == 0 ? 1 : 0);
+    }
+    return static_cast<std::int64_t>((low >> 32) | (high << 32));
+#endif
+}
+
+}  // namespace detail
+
+/**
+ * @brief Which clock a timer reads in its busy-wait
+ */
+enum class ClockSourceKind {
+    Auto,    ///< TSC when it passes validation, otherwise steady_clock
+    Steady,  ///< std::chrono::steady_clock
+    Tsc      ///< Calibrated invariant TSC (x86-64 Linux only), reporting why
+             ///< it fell back to steady_clock if validation fails
+};
+
+/**
+ * @brief Parse "auto", "steady" or "tsc"
+ * @throws std::invalid_argument for any other name
+ */
+ClockSourceKind parseClockSourceKind(const std::string& name);
+
+/**
+ * @brief Result of validating and calibrating the TSC against steady_clock
+ */
+struct TscCalibration {
+    bool usable               = false;
+    double ticksPerNanosecond = 0.0;
+    std::string reason;  ///< Why the TSC was rejected, empty if usable
+
+    // Conversion state: steady = baseSteadyNs + ((tsc - baseTsc) * mult >> 32)
+    std::uint64_t baseTsc     = 0;
+    std::int64_t baseSteadyNs = 0;
+    std::uint64_t mult        = 0;
+};
+
+/**
+ * @brief Validate and calibrate the TSC once per process
+ *
+ * Checks CPUID for an invariant TSC, then calibrates it against steady_clock
+ * over two consecutive windows and rejects it if they disagree. The first
+ * call takes a few tens of milliseconds; later calls return the cached
+ * result.
+ */
+const TscCalibration& tscCalibration();
+
+/**
+ * @brief A clock read through either steady_clock or the calibrated TSC
+ *
+ * Both backends return steady_clock time points, so callers can mix them
+ * with other steady_clock values. The backend is chosen once, and now()
+ * costs a single predictable branch on top of the clock read.
+ */
+class ClockSource {
+public:
+    using time_point = std::chrono::steady_clock::time_point;
+
+    /** @brief Steady-clock time between two TSC resyncs */
+    static constexpr std::chrono::seconds kResyncPeriod{10};
+
+    /**
+     * @brief Select a backend
+     * @param kind Requested clock; Auto and Tsc fall back to steady_clock
+     * when validation fails, Tsc also records fallbackReason()
+     */
+    explicit ClockSource(ClockSourceKind kind = ClockSourceKind::Auto);
+
+    time_point now() const noexcept {
+#ifdef TS_HAVE_TSC_CLOCK
+        if (useTsc_) {
+            unsigned int aux;
+            return time_point(
+                std::chrono::nanoseconds(tscToSteadyNs(__rdtscp(&aux))));
+        }
+#endif
+        return std::chrono::steady_clock::now();
+    }
+
+    /**
+     * @brief Bring the TSC mapping back in step with steady_clock once
+     * kResyncPeriod has passed since the last resync
+     *
+     * The startup calibration spans a few tens of milliseconds, so its
+     * small rate error grows into a drift over long runs. A resync measures
+     * the rate again over the whole span since the previous one and slews
+     * the mapping so that the offset it finds is gone by the next resync;
+     * now() never steps and stays monotonic. Call it between ticks, never
+     * inside a measured span: it is one compare unless due, and about a
+     * microsecond of steady_clock reads when it is.
+     * @return true if the mapping was resynced
+     */
+    bool resyncIfDue([[maybe_unused]] time_point now) {
+#ifdef TS_HAVE_TSC_CLOCK
+        if (useTsc_ && now >= nextResync_) {
+            resync();
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    bool isTsc() const {
+        return useTsc_;
+    }
+
+    /** @brief Short backend name: "tsc" or "steady_clock" */
+    const char* name() const {
+        return useTsc_ ? "tsc" : "steady_clock";
+    }
+
+    /** @brief Human readable description, e.g. "tsc (2.995 GHz)" */
+    std::string describe() const;
+
+    /** @brief Why a requested TSC fell back to steady_clock, or empty */
+    const std::string& fallbackReason() const {
+        return fallbackReason_;
+    }
+
+private:
+#ifdef TS_HAVE_TSC_CLOCK
+    std::int64_t tscToSteadyNs(std::uint64_t tsc) const noexcept {
+        // Signed, so that a core whose TSC is slightly behind the base maps
+        // just before it instead of wrapping to the far future
+        auto delta = static_cast<std::int64_t>(tsc - baseTsc_);
+        return baseSteadyNs_ +
+               detail::mulShift32(delta, static_cast<std::int64_t>(mult_));
+    }
+
+    void resync();
+#endif
+
+    bool useTsc_               = false;
+    std::uint64_t baseTsc_     = 0;
+    std::int64_t baseSteadyNs_ = 0;
+    std::uint64_t mult_        = 0;
+    double ticksPerNanosecond_ = 0.0;
+    std::string fallbackReason_;
+
+    // Last TSC/steady_clock pair measured, and when the next resync is due
+    std::uint64_t syncTsc_     = 0;
+    std::int64_t syncSteadyNs_ = 0;
+    time_point nextResync_;
+};
+
+}  // namespace ts
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "clock_source.hpp"
+#include "histogram.hpp"
+#include "periodic_executor.hpp"
+#include "timer_policies.hpp"
+#include "utils.hpp"
+
+namespace ts {
+
+class CoroExecutor;
+
+/**
+ * @brief Coroutine type for periodic workloads run by a CoroExecutor
+ *
+ * The coroutine starts suspended and is started by CoroExecutor::spawn();
+ * the executor owns and destroys the frame.
+ */
+class PeriodicTask {
+public:
+    struct promise_type {
+        std::exception_ptr exception;
+
+        PeriodicTask get_return_object() {
+            return PeriodicTask(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    PeriodicTask(PeriodicTask&& other) noexcept
+        : handle_(std::exchange(other.handle_, {})) {}
+
+    PeriodicTask& operator=(PeriodicTask&&) = delete;
+
+    ~PeriodicTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+private:
+    friend class CoroExecutor;
+
+    explicit PeriodicTask(Handle handle) : handle_(handle) {}
+
+    Handle handle_;
+};
+
+/**
+ * @brief Drift-free deadline sequence for one coroutine
+ *
+ * `co_await ticker.next()` suspends the coroutine until the next deadline
+ * (previous deadline plus one period; the first is one period after the
+ * first call) and evaluates to the TickInfo of the resumption. Lateness of
+ * every resumption is recorded into the ticker's own histogram.
+ */
+class Ticker {
+public:
+    class Awaiter {
+    public:
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle);
+
+        TickInfo await_resume() const noexcept;
+
+    private:
+        friend class Ticker;
+
+        explicit Awaiter(Ticker& ticker) : ticker_(ticker) {}
+
+        Ticker& ticker_;
+    };
+
+    /**
+     * @param executor Executor resuming the awaiting coroutine
+     * @param period Time between deadlines
+     * @param histogramBits Precision of the lateness histogram
+     * @throws std::invalid_argument if period is not positive
+     */
+    Ticker(CoroExecutor& executor, std::chrono::nanoseconds period,
+           int histogramBits = 7);
+
+    Ticker(const Ticker&)            = delete;
+    Ticker& operator=(const Ticker&) = delete;
+
+    /** @brief Wait for the next deadline */
+    Awaiter next() {
+        return Awaiter(*this);
+    }
+
+    std::chrono::nanoseconds period() const {
+        return period_;
+    }
+
+    /** @brief Resumption lateness in nanoseconds */
+    const LatencyHistogram& lateness() const {
+        return lateness_;
+    }
+
+    /**
+     * @brief Lateness statistics
+     * @param nanosecondsPerUnit Scale of the reported unit, e.g. 1e3 for us
+     */
+    ::utils::TimingStats latenessStats(double nanosecondsPerUnit) const {
+        return makeTimingStats(lateness_, nanosecondsPerUnit);
+    }
+
+private:
+    friend class CoroExecutor;
+
+    CoroExecutor& executor_;
+    std::chrono::nanoseconds period_;
+    std::int64_t deadlineNs_ = 0;  // 0 until the first next()
+    std::uint64_t index_     = 0;
+    TickInfo last_{};
+    LatencyHistogram lateness_;
+};
+
+/**
+ * @brief Single-threaded executor resuming many coroutines at their
+ * deadlines
+ *
+ * Suspended coroutines wait in a min-heap ordered by deadline. The executor
+ * thread sleeps until shortly before the earliest deadline and spins for
+ * the rest, with the same SleepSpinWait strategy (and adaptive spin margin)
+ * that Timer uses, then resumes every coroutine that is due. Coroutines
+ * share that one thread, so a coroutine that runs long delays the others;
+ * that delay shows up in their lateness.
+ *
+ * Heap storage is reserved up front and grows only when more coroutines
+ * are suspended at once than ever before, so steady-state ticks do not
+ * allocate. The executor is not thread-safe, except for stop().
+ */
+class CoroExecutor {
+public:
+    /**
+     * @param shortestPeriod Shortest ticker period; the spin margin is capped
+     * at half of it
+     * @param expectedTasks Heap capacity to reserve
+     */
+    explicit CoroExecutor(std::chrono::nanoseconds shortestPeriod,
+                          std::size_t expectedTasks = 64);
+
+    /** @brief Destroys the frames of unfinished coroutines */
+    ~CoroExecutor();
+
+    CoroExecutor(const CoroExecutor&)            = delete;
+    CoroExecutor& operator=(const CoroExecutor&) = delete;
+
+    /**
+     * @brief Take ownership of a coroutine; it starts running (up to its
+     * first co_await) when run() is called
+     */
+    void spawn(PeriodicTask task);
+
+    /**
+     * @brief Resume coroutines at their deadlines until every coroutine has
+     * finished, stop() is called or the clock passes until
+     * @throws The first exception escaping a coroutine, after which the
+     * executor stops
+     */
+    void run(std::chrono::steady_clock::time_point until);
+
+    /** @brief Ask run() to return after the current resumption */
+    void stop() {
+        stopRequested_.store(true, std::memory_order_relaxed);
+    }
+
+    std::chrono::steady_clock::time_point now() const {
+        return clock_.now();
+    }
+
+    /** @brief Resumptions since construction */
+    std::uint64_t resumptions() const {
+        return resumptions_;
+    }
+
+    AdaptiveSpinScheduler::Report schedulerReport() const {
+        return wait_.report();
+    }
+
+private:
+    friend class Ticker;
+
+    struct Pending {
+        std::int64_t deadlineNs;
+        std::uint64_t sequence;  // FIFO among equal deadlines
+        std::coroutine_handle<> handle;
+        Ticker* ticker;
+    };
+
+    struct Later {
+        bool operator()(const Pending& a, const Pending& b) const {
+            return a.deadlineNs != b.deadlineNs ? a.deadlineNs > b.deadlineNs
+                                                : a.sequence > b.sequence;
+        }
+    };
+
+    void schedule(Ticker& ticker, std::coroutine_handle<> handle);
+    void resume(std::coroutine_handle<> handle);
+    void reap(std::coroutine_handle<> handle);
+
+    ClockSource clock_;
+    SleepSpinWait wait_;
+    std::vector<Pending> heap_;
+    std::vector<PeriodicTask::Handle> tasks_;
+    std::vector<PeriodicTask::Handle> unstarted_;
+    std::uint64_t sequence_    = 0;
+    std::uint64_t resumptions_ = 0;
+    std::exception_ptr error_;
+    std::atomic<bool> stopRequested_{false};
+};
+
+/**
+ * @brief Run count coroutines with periods of 1x to 4x intervalSec on one
+ * CoroExecutor for intervals base intervals, then log their aggregate
+ * lateness, the worst coroutines and the executor's sleep/spin split
+ */
+void runCoroutineTickers(double intervalSec, std::size_t count,
+                         std::size_t intervals);
+
+}  // namespace ts
@@ -1,21 +1,17 @@
 #pragma once
 
-#include <chrono>
-#include <cstddef>
-
-#include "base_timer.hpp"
+#include "basic_timer.hpp"
+#include "clock_source.hpp"
+#include "timer_policies.hpp"
 
 namespace ts {
 
-class HighResTimer : public BaseTimer {
-public:
-    explicit HighResTimer(double intervalSec);
-
-    void run(std::size_t iterations = 100) override;
+/**
+ * @brief Busy-wait timer on a ClockSource (steady_clock or TSC), reporting
+ * microseconds; used for sub-kHighResThresholdSec intervals
+ */
+using HighResTimer = BasicTimer<ClockSource, Microseconds, BusySpinWait>;
 
-private:
-    std::chrono::steady_clock::time_point lastTimePoint_;
-    std::chrono::steady_clock::time_point now() const;
-};
+extern template class BasicTimer<ClockSource, Microseconds, BusySpinWait>;
 
 }  // namespace ts
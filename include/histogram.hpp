@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "utils.hpp"
+
+namespace ts {
+
+/**
+ * @brief Constant-memory log-linear (HDR-style) histogram of non-negative
+ * integer values
+ *
+ * Values below 2^significantBits are counted exactly. Above that, every
+ * power-of-two range is split into 2^(significantBits - 1) equal buckets, so
+ * any recorded value is reproduced with a relative error of at most
+ * 2^-(significantBits - 1). All storage is allocated in the constructor;
+ * record() is O(1) and never allocates.
+ */
+class LatencyHistogram {
+public:
+    /** @brief Default upper bound: one hour expressed in nanoseconds */
+    static constexpr std::uint64_t kDefaultHighestTrackable =
+        3600ULL * 1000000000ULL;
+
+    /** @brief Default precision: about 0.1% relative error */
+    static constexpr int kDefaultSignificantBits = 11;
+
+    /**
+     * @brief Allocate the bucket array
+     * @param highestTrackableValue Largest value tracked without clamping
+     * @param significantBits Precision in bits (2 to 20)
+     * @throws std::invalid_argument if the parameters are out of range
+     */
+    explicit LatencyHistogram(
+        std::uint64_t highestTrackableValue = kDefaultHighestTrackable,
+        int significantBits                 = kDefaultSignificantBits);
+
+    /**
+     * @brief Record a single value
+     * @param value The value; anything above the trackable range is clamped
+     * into the top bucket and counted as an overflow
+     */
+    void record(std::uint64_t value) noexcept {
+        if (value > highestTrackable_) {
+            value = highestTrackable_;
+            ++overflowCount_;
+        }
+        ++counts_[indexFor(value)];
+        ++totalCount_;
+        sum_ += value;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+    }
+
+    /**
+     * @brief Add every count from another histogram with the same layout
+     * @throws std::invalid_argument if the layouts differ
+     */
+    void merge(const LatencyHistogram& other);
+
+    /**
+     * @brief Remove every count of another histogram with the same layout
+     * whose values were also recorded into or merged into this one
+     *
+     * min() and max() cannot be narrowed by a removal, so they keep
+     * covering the removed values until the histogram is empty.
+     * @throws std::invalid_argument if the layouts differ
+     */
+    void subtract(const LatencyHistogram& other);
+
+    /** @brief Clear all counts without releasing memory */
+    void reset() noexcept;
+
+    /**
+     * @brief Estimate the value at a percentile
+     * @param p Percentile fraction (0.0 to 1.0), e.g. 0.9999 for p99.99
+     * @return Representative value of the bucket holding that rank, or 0 if
+     * the histogram is empty
+     */
+    std::uint64_t valueAtPercentile(double p) const;
+
+    /** @brief Exact arithmetic mean of the recorded values */
+    double mean() const {
+        return totalCount_ == 0 ? 0.0
+                                : static_cast<double>(sum_) /
+                                      static_cast<double>(totalCount_);
+    }
+
+    /**
+     * @brief Estimate the population standard deviation from the bucket
+     * representatives
+     */
+    double stddev() const;
+
+    /**
+     * @brief Estimate the mean absolute deviation from a reference value
+     * from the bucket representatives
+     */
+    double meanAbsDeviation(std::uint64_t reference) const;
+
+    std::uint64_t count() const {
+        return totalCount_;
+    }
+
+    std::uint64_t min() const {
+        return totalCount_ == 0 ? 0 : min_;
+    }
+
+    std::uint64_t max() const {
+        return max_;
+    }
+
+    std::uint64_t overflowCount() const {
+        return overflowCount_;
+    }
+
+    std::uint64_t highestTrackableValue() const {
+        return highestTrackable_;
+    }
+
+    int significantBits() const {
+        return significantBits_;
+    }
+
+    /** @brief Number of buckets, i.e. the fixed memory footprint in counts */
+    std::size_t bucketCount() const {
+        return counts_.size();
+    }
+
+private:
+    static int highestBit(std::uint64_t v) noexcept {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+
+    std::size_t indexFor(std::uint64_t v) const noexcept {
+        if (v < subBucketCount_) {
+            return static_cast<std::size_t>(v);
+        }
+        int shift              = highestBit(v) - significantBits_ + 1;
+        std::uint64_t mantissa = v >> shift;
+        return static_cast<std::size_t>(
+            subBucketCount_ +
+            static_cast<std::uint64_t>(shift - 1) * subBucketHalfCount_ +
+            (mantissa - subBucketHalfCount_));
+    }
+
+    std::uint64_t lowestValueAt(std::size_t index) const noexcept;
+    std::uint64_t bucketWidthAt(std::size_t index) const noexcept;
+
+    // Middle of the bucket, the value every count in it stands for
+    std::uint64_t representativeAt(std::size_t index) const noexcept {
+        return lowestValueAt(index) + (bucketWidthAt(index) - 1) / 2;
+    }
+
+    int significantBits_;
+    std::uint64_t subBucketCount_;
+    std::uint64_t subBucketHalfCount_;
+    std::uint64_t highestTrackable_;
+    std::vector<std::uint64_t> counts_;
+
+    std::uint64_t totalCount_    = 0;
+    std::uint64_t overflowCount_ = 0;
+    std::uint64_t sum_           = 0;
+    std::uint64_t min_           = UINT64_MAX;
+    std::uint64_t max_           = 0;
+};
+
+/**
+ * @brief Build TimingStats from a histogram of nanosecond values
+ * @param histogram Histogram holding at least one value
+ * @param nanosecondsPerUnit Scale of the reported unit, e.g. 1e3 for us
+ * @param targetNs Reference of the mean absolute deviation; 0 leaves it NaN
+ * @return Statistics expressed in the reported unit; maxJitter is NaN since
+ * a histogram does not keep the order of its values
+ */
+::utils::TimingStats makeTimingStats(const LatencyHistogram& histogram,
+                                     double nanosecondsPerUnit,
+                                     std::int64_t targetNs = 0);
+
+}  // namespace ts
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "options.hpp"
+#include "stressor.hpp"
+#include "timer_factory.hpp"
+#include "utils.hpp"
+
+namespace ts {
+
+/**
+ * @brief Lateness of one phase of an interference run, in microseconds
+ */
+struct InterferencePhase {
+    std::string label;  ///< "baseline", a stressor spec, or "all"
+    ::utils::TimingStats lateness;
+    std::string load;  ///< Work rate of every stressor of the phase
+};
+
+/**
+ * @brief Runs the timer unloaded and then next to each stressor group
+ *
+ * The baseline runs first, then one phase per stressor group and, with
+ * several groups, a last phase with all of them together. Every phase
+ * runs the same timer for options.iterations ticks with per-tick output
+ * off; the stressors start, and get to allocate their buffers, before the
+ * timer does.
+ */
+class InterferenceRunner {
+public:
+    /**
+     * @param options Timer settings with stressors set
+     * @throws std::invalid_argument if a sibling placement cannot be
+     * resolved
+     */
+    explicit InterferenceRunner(const Options& options);
+
+    /**
+     * @brief Run every phase in order, logging progress
+     * @return The phases that collected ticks; a stop request ends the
+     * current phase early and skips the rest
+     */
+    std::vector<InterferencePhase> run();
+
+    /** @brief Ask run() to return soon; async-signal-safe */
+    void requestStop();
+
+private:
+    InterferencePhase runPhase(const std::string& label,
+                               const std::vector<StressorSpec>& specs);
+
+    Options options_;
+    std::vector<StressorSpec> stressors_;  // Siblings resolved
+    AnyTimer timer_;
+    std::atomic<bool> stopRequested_{false};
+};
+
+/**
+ * @brief Log the phases as one table, with the change of each percentile
+ * against the baseline
+ */
+void printInterferenceTable(const std::vector<InterferencePhase>& phases);
+
+}  // namespace ts
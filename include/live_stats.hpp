@@ -0,0 +1,189 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "histogram.hpp"
+
+namespace ts {
+
+/**
+ * @brief Running statistics a timer publishes while it runs, in
+ * nanoseconds
+ *
+ * Trivially copyable, so that it travels through the shared-memory segment
+ * as plain 64-bit words.
+ */
+struct LiveStats {
+    char clockSource[24];         ///< e.g. "steady_clock", "tsc"
+    char unit[8];                 ///< Display unit of the timer
+    std::uint64_t running;        ///< 1 while run() is in its loop
+    std::uint64_t count;          ///< Intervals recorded this run
+    std::int64_t intervalNs;      ///< Target interval
+    std::int64_t lastIntervalNs;
+    std::int64_t lastLatenessNs;  ///< Of the last tick, against its deadline
+    std::int64_t maxLatenessNs;   ///< Over the run
+    std::int64_t windowNs;        ///< Length of the percentile window
+    std::uint64_t windowCount;    ///< Intervals in the last full window
+    std::int64_t windowP50Ns;
+    std::int64_t windowP99Ns;
+    std::int64_t windowP999Ns;
+    std::int64_t windowMaxNs;
+};
+
+/**
+ * @brief Fixed layout at the start of a live statistics segment
+ */
+struct LiveStatsHeader {
+    static constexpr char kMagic[8] = {'T', 'S', 'L', 'I', 'V', 'E', 0, 0};
+    static constexpr std::uint32_t kVersion = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t statsSize;  ///< sizeof(LiveStats) of the writer
+    std::int64_t pid;         ///< Publishing process
+};
+
+/**
+ * @brief Publishes a timer's LiveStats into a POSIX shared-memory segment
+ *
+ * The timing thread is the only writer. Every record() updates the segment
+ * under a seqlock: the sequence number is odd while the words are being
+ * stored, and readers retry until they copy them between two equal even
+ * sequence numbers. Writes therefore never wait for a reader, and readers
+ * never block the timer.
+ *
+ * Window percentiles are rolling: the window is split into kWindowSlices
+ * slice histograms, and at the end of every slice the percentiles of the
+ * last full window are published. A window histogram is kept up to date
+ * alongside the slices, so closing a slice costs one subtraction and one
+ * scan of a small histogram instead of a merge of every slice. Everything
+ * is allocated in the constructor.
+ */
+class LiveStatsPublisher {
+public:
+    static constexpr int kWindowSlices = 10;
+
+    /** @brief Histogram precision of the window (about 1.6% error) */
+    static constexpr int kHistogramBits = 7;
+
+    /** @brief Intervals above this are clamped in the window percentiles */
+    static constexpr std::uint64_t kHighestTrackableNs = 10000000000ULL;
+
+    /**
+     * @brief Create (or take over) the segment
+     * @param name Segment name, with or without the leading '/'
+     * @param window Length of the percentile window
+     * @throws std::invalid_argument on an empty name or a window shorter
+     * than kWindowSlices nanoseconds
+     * @throws std::runtime_error if the segment cannot be created
+     */
+    LiveStatsPublisher(const std::string& name,
+                       std::chrono::nanoseconds window);
+
+    /** @brief Unmap the segment and remove its name */
+    ~LiveStatsPublisher();
+
+    LiveStatsPublisher(const LiveStatsPublisher&)            = delete;
+    LiveStatsPublisher& operator=(const LiveStatsPublisher&) = delete;
+
+    /** @brief Clear the previous run and publish the new run's settings */
+    void begin(const char* clockName, const char* unit,
+               std::int64_t intervalNs);
+
+    /**
+     * @brief Align the window to the run's first timestamp
+     * @param startNs In the timer clock's epoch
+     */
+    void start(std::int64_t startNs);
+
+    /**
+     * @brief Account one tick and publish it (O(1) except at the end of a
+     * slice, allocation free)
+     * @param nowNs Timestamp of the tick, in the timer clock's epoch
+     * @param intervalNs Measured interval
+     * @param latenessNs Timestamp minus the tick's deadline
+     */
+    void record(std::int64_t nowNs, std::int64_t intervalNs,
+                std::int64_t latenessNs) {
+        if (nowNs >= sliceEndNs_) {
+            closeSlices(nowNs);
+        }
+        std::uint64_t ns =
+            static_cast<std::uint64_t>(intervalNs < 0 ? 0 : intervalNs);
+        slices_[current_].record(ns);
+        window_.record(ns);
+
+        ++stats_.count;
+        stats_.lastIntervalNs = intervalNs;
+        stats_.lastLatenessNs = latenessNs;
+        if (latenessNs > stats_.maxLatenessNs) {
+            stats_.maxLatenessNs = latenessNs;
+        }
+        publish();
+    }
+
+    /** @brief Mark the run as finished */
+    void end();
+
+    const std::string& name() const {
+        return name_;
+    }
+
+private:
+    // Publish the window ending with the current slice, then move on to
+    // the slice holding nowNs
+    void closeSlices(std::int64_t nowNs);
+    void publish();
+
+    std::string name_;
+    void* mapping_                        = nullptr;
+    std::atomic<std::uint64_t>* sequence_ = nullptr;
+    std::atomic<std::uint64_t>* words_    = nullptr;
+    LiveStats stats_{};
+    std::vector<LatencyHistogram> slices_;  // Ring of the window's slices
+    LatencyHistogram window_;               // Sum of the slices
+    std::size_t current_     = 0;
+    std::int64_t sliceNs_    = 0;
+    std::int64_t sliceEndNs_ = INT64_MAX;  // Nothing closes before start()
+};
+
+/**
+ * @brief Read-only view of a segment written by a LiveStatsPublisher
+ */
+class LiveStatsReader {
+public:
+    /**
+     * @param name Segment name, with or without the leading '/'
+     * @throws std::runtime_error if the segment does not exist or is not a
+     * live statistics segment
+     */
+    explicit LiveStatsReader(const std::string& name);
+    ~LiveStatsReader();
+
+    LiveStatsReader(const LiveStatsReader&)            = delete;
+    LiveStatsReader& operator=(const LiveStatsReader&) = delete;
+
+    /**
+     * @brief Copy a consistent snapshot of the statistics
+     * @return false if the writer kept the segment busy for every attempt
+     */
+    bool read(LiveStats& out) const;
+
+    /** @brief Process that publishes the segment */
+    std::int64_t pid() const;
+
+    const std::string& name() const {
+        return name_;
+    }
+
+private:
+    std::string name_;
+    const void* mapping_ = nullptr;
+};
+
+}  // namespace ts
@@ -1,29 +1,108 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace logging {
 
 class Logger {
 public:
+    /** @brief Default bound on formatted bytes queued in async mode */
+    static constexpr std::size_t kDefaultAsyncMemoryLimit = 8u << 20;
+
+    /** @brief Log to the console only, until openFile() is called */
+    Logger();
+
     /**
      * @brief open a file to write logs
      * @param folderPath The folder of the log file
      */
-    explicit Logger(const std::string& folderPath = "logs");
+    explicit Logger(const std::string& folderPath);
 
-    /** @brief close the log file */
+    /** @brief drain pending records and close the log file */
     ~Logger();
 
+    Logger(const Logger&)            = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    /**
+     * @brief Also write everything to a new timestamped file in folderPath,
+     * creating the folder; must not be called while other threads log
+     * @throws std::runtime_error if the folder or file cannot be created
+     */
+    void openFile(const std::string& folderPath = "logs");
+
+    /**
+     * @brief Send console output to another stream, or discard it with
+     * nullptr (default std::cout); must not be called while other threads
+     * log
+     */
+    void setConsole(std::ostream* console) {
+        console_ = console;
+    }
+
+    /**
+     * @brief Switch between synchronous and asynchronous output
+     *
+     * In async mode every thread formats into its own buffers, and a
+     * completed line (or 4 KiB of text) is handed to a background thread
+     * that writes everything pending with one large write per destination.
+     * Console and file output are reordered relative to direct std::cout
+     * writes until flush() is called. Records that would push the queued
+     * bytes past memoryLimitBytes are dropped and counted instead of
+     * blocking the caller. Must not be called while other threads log.
+     * @param enabled true to start the drain thread, false to flush and
+     * stop it
+     * @param memoryLimitBytes Bound on formatted bytes awaiting the drain
+     * thread
+     */
+    void setAsync(bool enabled,
+                  std::size_t memoryLimitBytes = kDefaultAsyncMemoryLimit);
+
+    bool isAsync() const {
+        return async_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Write everything logged so far, including the calling thread's
+     * unfinished line; in async mode blocks until the drain thread has
+     * written it. Unfinished lines of other threads are left buffered.
+     */
+    void flush();
+
+    /** @brief Bytes discarded because the async memory limit was reached */
+    std::uint64_t droppedBytes() const {
+        return droppedBytes_.load(std::memory_order_relaxed);
+    }
+
     /**
      * @brief Log a value to both console and file
      * @param value The value to log
      */
     template <typename T>
     Logger& operator<<(const T& value) {
-        std::cout << value;
+        if (isAsync()) {
+            ThreadBuffer& buffer = threadBuffer();
+            buffer.console << value;
+            if (logFileOpened) {
+                buffer.file << value;
+            }
+            publishIfComplete(buffer);
+            return *this;
+        }
+        if (console_ != nullptr) {
+            *console_ << value;
+        }
         if (logFileOpened && file.is_open()) {
             file << value;
         }
@@ -35,7 +114,18 @@ public:
      * @param manip The manipulator function
      */
     Logger& operator<<(std::ostream& (*manip)(std::ostream&)) {
-        manip(std::cout);
+        if (isAsync()) {
+            ThreadBuffer& buffer = threadBuffer();
+            manip(buffer.console);
+            if (logFileOpened) {
+                manip(buffer.file);
+            }
+            publishIfComplete(buffer);
+            return *this;
+        }
+        if (console_ != nullptr) {
+            manip(*console_);
+        }
         if (logFileOpened && file.is_open()) {
             manip(file);
         }
@@ -48,7 +138,17 @@ public:
      * @param manip The ios_base manipulator function
      */
     Logger& operator<<(std::ios_base& (*manip)(std::ios_base&)) {
-        manip(std::cout);
+        if (isAsync()) {
+            ThreadBuffer& buffer = threadBuffer();
+            manip(buffer.console);
+            if (logFileOpened) {
+                manip(buffer.file);
+            }
+            return *this;
+        }
+        if (console_ != nullptr) {
+            manip(*console_);
+        }
         if (logFileOpened && file.is_open()) {
             manip(file);
         }
@@ -60,30 +160,30 @@ public:
      */
     class FileOnlyProxy {
     public:
-        explicit FileOnlyProxy(std::ofstream& f, bool open)
-            : file_(f), open_(open) {}
+        explicit FileOnlyProxy(Logger& logger, bool open)
+            : logger_(logger), open_(open) {}
 
         template <typename T>
         FileOnlyProxy& operator<<(const T& value) {
             if (open_)
-                file_ << value;
+                logger_.writeFileOnly(value);
             return *this;
         }
 
         FileOnlyProxy& operator<<(std::ostream& (*manip)(std::ostream&)) {
             if (open_)
-                manip(file_);
+                logger_.writeFileOnly(manip);
             return *this;
         }
 
         FileOnlyProxy& operator<<(std::ios_base& (*manip)(std::ios_base&)) {
             if (open_)
-                manip(file_);
+                logger_.writeFileOnly(manip);
             return *this;
         }
 
     private:
-        std::ofstream& file_;
+        Logger& logger_;
         bool open_;
     };
 
@@ -91,14 +191,118 @@ public:
      * @brief Get a proxy that writes only to the log file
      */
     FileOnlyProxy fileOnly() {
-        return FileOnlyProxy(file, logFileOpened && file.is_open());
+        return FileOnlyProxy(*this, logFileOpened && file.is_open());
     }
 
 private:
+    /** @brief Unbuffered streambuf appending to a reusable string */
+    class StringSink : public std::streambuf {
+    public:
+        std::string text;
+
+    protected:
+        int_type overflow(int_type c) override {
+            if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                text.push_back(traits_type::to_char_type(c));
+            }
+            return traits_type::not_eof(c);
+        }
+
+        std::streamsize xsputn(const char* s, std::streamsize n) override {
+            text.append(s, static_cast<std::size_t>(n));
+            return n;
+        }
+    };
+
+    /**
+     * @brief One logging thread's formatting streams and its published
+     * records; the drain thread swaps pending* with its own spare strings
+     */
+    struct ThreadBuffer {
+        StringSink consoleSink;
+        StringSink fileSink;
+        std::ostream console{&consoleSink};
+        std::ostream file{&fileSink};
+
+        std::mutex mutex;
+        std::string pendingConsole;  // Guarded by mutex
+        std::string pendingFile;     // Guarded by mutex
+    };
+
+    /** @brief Lines shorter than this are published only once complete */
+    static constexpr std::size_t kPublishBytes = 4096;
+    /** @brief Queued bytes that wake the drain thread before its period */
+    static constexpr std::size_t kBatchBytes = 64 * 1024;
+
+    template <typename T>
+    void writeFileOnly(const T& value) {
+        if (isAsync()) {
+            ThreadBuffer& buffer = threadBuffer();
+            buffer.file << value;
+            publishIfComplete(buffer);
+            return;
+        }
+        file << value;
+    }
+
+    void writeFileOnly(std::ostream& (*manip)(std::ostream&)) {
+        if (isAsync()) {
+            ThreadBuffer& buffer = threadBuffer();
+            manip(buffer.file);
+            publishIfComplete(buffer);
+            return;
+        }
+        manip(file);
+    }
+
+    void writeFileOnly(std::ios_base& (*manip)(std::ios_base&)) {
+        manip(isAsync() ? threadBuffer().file : file);
+    }
+
+    void publishIfComplete(ThreadBuffer& buffer) {
+        const std::string& console  = buffer.consoleSink.text;
+        const std::string& fileText = buffer.fileSink.text;
+        if ((!console.empty() && console.back() == '\n') ||
+            (!fileText.empty() && fileText.back() == '\n') ||
+            console.size() + fileText.size() >= kPublishBytes) {
+            publish(buffer);
+        }
+    }
+
+    ThreadBuffer& threadBuffer();
+    void publish(ThreadBuffer& buffer);
+    void stopDrainThread();
+    void drainLoop();
+    void drainOnce();
+
     std::ofstream file;
+    std::ostream* console_ = &std::cout;
 
     bool logFileOpened = false;
 
+    const std::uint64_t id_;
+    std::atomic<bool> async_{false};
+    std::size_t memoryLimit_ = kDefaultAsyncMemoryLimit;
+    std::atomic<std::size_t> pendingBytes_{0};
+    std::atomic<std::uint64_t> droppedBytes_{0};
+
+    std::mutex registryMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> registry_;
+
+    std::thread drainThread_;
+    std::mutex drainMutex_;
+    std::condition_variable drainCv_;
+    std::condition_variable flushedCv_;
+    bool stopDrain_               = false;  // Guarded by drainMutex_
+    std::uint64_t flushRequested_ = 0;      // Guarded by drainMutex_
+    std::uint64_t flushCompleted_ = 0;      // Guarded by drainMutex_
+
+    // Drain thread only
+    std::string spareConsole_;
+    std::string spareFile_;
+    std::string batchConsole_;
+    std::string batchFile_;
+
     std::string generateFilenameWithoutExtension();
 
     bool checkFolderExists(const std::string& folderPath);
@@ -110,4 +314,12 @@ private:
 
 }  // namespace logging
 
-extern logging::Logger logger;
\ No newline at end of file
+/**
+ * @brief Logger every library report goes through
+ *
+ * Console only at startup, so that linking the library creates no files;
+ * an executable opts into a log file with logger.openFile(), and an
+ * embedding service can redirect or silence the console with
+ * logger.setConsole().
+ */
+extern logging::Logger logger;
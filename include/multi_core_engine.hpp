@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "options.hpp"
+#include "timer_factory.hpp"
+#include "utils.hpp"
+
+namespace ts {
+
+/**
+ * @brief Runs one timer per CPU concurrently to characterize jitter across
+ * the cores of a host
+ *
+ * Every instance gets its own thread pinned to a distinct CPU and its own
+ * timer object (and therefore its own histogram), so the hot paths share no
+ * mutable state. All threads are released together once every one of them
+ * is pinned. Per-tick console output is disabled; results are reported per
+ * core and merged afterwards.
+ */
+class MultiCoreEngine {
+public:
+    struct CoreResult {
+        int cpu;
+        bool pinned;
+        std::string pinError;
+        ::utils::TimingStats stats;
+    };
+
+    /**
+     * @param options Timer configuration shared by every instance
+     * @param cpus One timer is created per listed CPU
+     * @throws std::invalid_argument if cpus is empty
+     */
+    MultiCoreEngine(const Options& options, std::vector<int> cpus);
+
+    /**
+     * @brief Run every instance for the given number of iterations and
+     * wait for all of them
+     * @throws The first exception raised by any instance
+     */
+    void run(std::size_t iterations);
+
+    /** @brief Per-core statistics of the last run */
+    std::vector<CoreResult> results() const;
+
+    /** @brief Statistics over the intervals of every core */
+    ::utils::TimingStats mergedStatistics() const;
+
+    /**
+     * @brief Log the per-core table and the merged statistics, flagging
+     * cores whose p99 is well above the median core
+     */
+    void printReport() const;
+
+private:
+    std::vector<int> cpus_;
+    std::vector<AnyTimer> timers_;
+    std::vector<std::string> pinErrors_;
+};
+
+/**
+ * @brief Parse a CPU list such as "0,2-5" or "all"
+ * @throws std::invalid_argument on malformed input
+ */
+std::vector<int> parseCpuList(const std::string& list);
+
+}  // namespace ts
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base_timer.hpp"
+#include "clock_source.hpp"
+
+namespace ts {
+
+/**
+ * @brief One stretch during which the detector thread could not read the
+ * clock
+ */
+struct NoiseGap {
+    std::int64_t startNs;     ///< Last read before the gap, steady epoch
+    std::int64_t durationNs;  ///< Time between the two reads
+    bool detectorPreempted;   ///< The detector thread was switched out
+};
+
+/**
+ * @brief Configuration of a NoiseDetector
+ */
+struct NoiseDetectorOptions {
+    int cpu = -1;  ///< CPU to spin on, -1 leaves the thread unpinned
+    std::chrono::nanoseconds threshold{10000};  ///< Smallest recorded gap
+    std::size_t maxGaps       = 65536;  ///< Gaps beyond this are only counted
+    ClockSourceKind clockKind = ClockSourceKind::Auto;
+};
+
+/**
+ * @brief osnoise/hwlat-style detector of host interference
+ *
+ * A thread spins on its own CPU reading the clock back to back and records
+ * every gap between two reads longer than the threshold. Such a gap means
+ * that something other than the thread ran on the CPU: an interrupt, a
+ * preempting task, an SMI or the hypervisor. After each gap the detector
+ * thread's own involuntary context switch count tells its preemption apart
+ * from the rest; it says nothing about the timing thread on its own CPU.
+ * Interrupts taken by the CPU and, where the MSR can be read, SMIs are
+ * counted over the whole run to split the remainder.
+ *
+ * SMIs and most hypervisor exits stall every CPU, and many interrupts and
+ * preemptions hit CPUs together, so gaps on an otherwise idle neighbour of
+ * the timing CPU are a good proxy for what hit the timer. The gap buffer is
+ * allocated up front; the detector thread never allocates.
+ */
+class NoiseDetector {
+public:
+    /** @throws std::invalid_argument if threshold is not positive */
+    explicit NoiseDetector(const NoiseDetectorOptions& options);
+
+    /** @brief Stops the detector */
+    ~NoiseDetector();
+
+    NoiseDetector(const NoiseDetector&)            = delete;
+    NoiseDetector& operator=(const NoiseDetector&) = delete;
+
+    /** @brief Clear the previous results and start spinning */
+    void start();
+
+    /** @brief Stop spinning and join the thread */
+    void stop();
+
+    /** @brief Recorded gaps in time order; read after stop() */
+    const std::vector<NoiseGap>& gaps() const {
+        return gaps_;
+    }
+
+    /** @brief Gaps above the threshold that did not fit the buffer */
+    std::uint64_t droppedGaps() const {
+        return droppedGaps_;
+    }
+
+    /** @brief Clock reads performed by the detector thread */
+    std::uint64_t samples() const {
+        return samples_;
+    }
+
+    /** @brief Time between start() and stop() */
+    std::chrono::nanoseconds runTime() const {
+        return std::chrono::nanoseconds(endNs_ - startNs_);
+    }
+
+    /** @brief Interrupts the detector CPU took, or -1 if unknown */
+    long long interrupts() const {
+        return interrupts_;
+    }
+
+    /** @brief SMIs counted by MSR_SMI_COUNT, or -1 if unreadable */
+    long long smis() const {
+        return smis_;
+    }
+
+    /** @brief Why CPU pinning failed, or empty */
+    const std::string& pinError() const {
+        return pinError_;
+    }
+
+    const NoiseDetectorOptions& options() const {
+        return options_;
+    }
+
+private:
+    void loop();
+
+    NoiseDetectorOptions options_;
+    ClockSource clock_;
+    std::thread thread_;
+    std::atomic<bool> stopRequested_{false};
+    std::vector<NoiseGap> gaps_;
+    std::uint64_t droppedGaps_ = 0;
+    std::uint64_t samples_     = 0;
+    std::int64_t startNs_      = 0;
+    std::int64_t endNs_        = 0;
+    long long interrupts_      = -1;
+    long long smis_            = -1;
+    std::string pinError_;
+};
+
+/**
+ * @brief How much of a timer run's lateness coincides with detector gaps
+ */
+struct NoiseAttribution {
+    bool available                    = false;  ///< false without intervals
+    std::size_t ticks                 = 0;      ///< Ticks analyzed
+    std::size_t lateTicks             = 0;      ///< Later than the threshold
+    std::size_t lateWithGap           = 0;      ///< Late, overlapping a gap
+    std::int64_t latenessNs           = 0;      ///< Total of the late ticks
+    std::int64_t detectorPreemptionNs = 0;      ///< Detector preempted
+    std::int64_t otherNoiseNs         = 0;      ///< The other gaps
+    std::int64_t worstLateNs          = 0;
+    std::int64_t worstNoiseNs         = 0;      ///< Gaps in the worst tick
+};
+
+/**
+ * @brief Correlate the gaps with the late ticks of the timer's last run
+ *
+ * Tick times are rebuilt from the run's start and its raw intervals. A
+ * tick's lateness is measured against its grid deadline, or against the
+ * previous tick if that was later, so that lateness carried over from one
+ * tick is counted once. Gap time that overlaps the wait leading up to a
+ * late tick explains that tick's lateness, up to the lateness itself; the
+ * remainder is the timer's own. The split by gap kind describes what the
+ * detector CPU saw, not whether the timing thread itself was preempted.
+ *
+ * @param lateThreshold Ticks later than this count as late
+ */
+NoiseAttribution attributeLateness(const NoiseDetector& detector,
+                                   const BaseTimer& timer,
+                                   std::chrono::nanoseconds lateThreshold);
+
+/** @brief Log the gap summary and the attribution */
+void printNoiseReport(const NoiseDetector& detector,
+                      const NoiseAttribution& attribution);
+
+}  // namespace ts
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "clock_source.hpp"
+#include "overrun_policy.hpp"
+#include "realtime.hpp"
+#include "run_arena.hpp"
+#include "soak.hpp"
+#include "spin_wait.hpp"
+#include "stressor.hpp"
+
+namespace ts {
+
+/**
+ * @brief Which timer specialization runs an interval
+ */
+enum class TimerKind {
+    Auto,     ///< HighResTimer below kHighResThresholdSec, Timer otherwise
+    Timer,    ///< Sleep then spin, milliseconds
+    HighRes   ///< Busy-wait, microseconds
+};
+
+/**
+ * @brief Parse "auto", "timer" or "highres"
+ * @throws std::invalid_argument on anything else
+ */
+TimerKind parseTimerKind(const std::string& name);
+
+/**
+ * @brief Command line configuration of the timer executable
+ */
+struct Options {
+    double intervalSec        = 0.0;
+    TimerKind timerKind       = TimerKind::Auto;
+    ClockSourceKind clockKind = ClockSourceKind::Auto;
+    double spinMarginSec      = -1.0;  ///< <= 0 keeps the adaptive margin
+    SpinPolicy spinPolicy     = SpinPolicy::Auto;
+    RealtimeOptions realtime;
+    OverrunPolicy overrunPolicy = OverrunPolicy::CatchUp;
+    bool excludeCatchUp         = false;  ///< Report catch-up ticks apart
+    RunArenaOptions arena;  ///< Prefaulted, locked per-run buffers
+    std::vector<int> cores;    ///< Non-empty runs one timer per listed CPU
+    int wheelProbes      = 0;  ///< > 0 hosts that many probes on a timing wheel
+    int coroutineTickers = 0;  ///< > 0 runs that many coroutine tickers
+    std::string capturePath;   ///< Binary raw interval capture, empty for text
+    std::string tracePath;     ///< Chrome trace JSON of the run, empty for none
+    bool asyncLog = false;     ///< Log through the background drain thread
+
+    /** @brief CPU of the host noise detector, -1 runs none */
+    int noiseCpu             = -1;
+    double noiseThresholdSec = 10e-6;  ///< Smallest gap and lateness counted
+
+    /** @brief Shared-memory segment of the live statistics, empty for none */
+    std::string liveStatsName;
+    double liveWindowSec = 1.0;  ///< Rolling percentile window
+
+    /** @brief Intervals per run; 0 runs until interrupted */
+    std::size_t iterations = 100;
+
+    /** @brief Non-empty logs windowed statistics while the timer runs */
+    std::vector<SoakWindow> soakWindows;
+
+    /** @brief Non-empty runs an unloaded baseline, then each stressor */
+    std::vector<StressorSpec> stressors;
+
+    /** @brief Non-empty runs every interval in one process instead */
+    std::vector<double> sweepIntervals;
+    std::vector<std::size_t> sweepIterations;  ///< Per interval, in order
+    std::string sweepReportPath;  ///< CSV, or JSON for a .json path
+};
+
+/**
+ * @brief Parse the command line
+ * @param argc Argument count from main
+ * @param argv Argument vector from main
+ * @return Parsed options
+ * @throws std::invalid_argument on a missing, unknown or malformed argument
+ */
+Options parseOptions(int argc, char* argv[]);
+
+/**
+ * @brief Print command line help to stderr
+ * @param programName argv[0]
+ */
+void printUsage(const char* programName);
+
+}  // namespace ts
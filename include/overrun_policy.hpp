@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace ts {
+
+/**
+ * @brief What the timing loop does after a tick woke up past one or more
+ * later deadlines, e.g. after the thread was preempted
+ */
+enum class OverrunPolicy {
+    CatchUp,  ///< Keep the grid and fire the missed deadlines back to back
+    Skip,     ///< Keep the grid and wait for the next slot still ahead
+    Reanchor  ///< Restart the grid at the late tick
+};
+
+/**
+ * @brief Parse "catch-up", "skip" or "reanchor"
+ * @throws std::invalid_argument for any other name
+ */
+OverrunPolicy parseOverrunPolicy(const std::string& name);
+
+const char* overrunPolicyName(OverrunPolicy policy);
+
+/**
+ * @brief Deadline overruns of one run
+ */
+struct OverrunStats {
+    std::uint64_t overruns;         ///< Ticks that woke past a later deadline
+    std::uint64_t missedDeadlines;  ///< Deadlines already past at those ticks
+    std::uint64_t catchUpTicks;     ///< Ticks fired for a past deadline
+    std::int64_t longestOverrunNs;  ///< Largest lateness of those ticks
+};
+
+}  // namespace ts
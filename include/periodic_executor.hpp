@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include "clock_source.hpp"
+#include "histogram.hpp"
+#include "realtime.hpp"
+#include "timer_policies.hpp"
+
+namespace ts {
+
+/**
+ * @brief How the executor waits for each deadline
+ */
+enum class ExecutorStrategy {
+    Auto,       ///< BusySpin below kHighResThresholdSec, SleepSpin otherwise
+    SleepSpin,  ///< Timer: sleep until shortly before, then spin
+    BusySpin    ///< HighResTimer: spin on the clock for the whole period
+};
+
+/**
+ * @brief Per-tick context passed to the callback
+ */
+struct TickInfo {
+    std::uint64_t index;  ///< Deadline number; skipped deadlines leave gaps
+    std::chrono::steady_clock::time_point deadline;
+    std::chrono::nanoseconds lateness;  ///< Callback start minus deadline
+};
+
+/**
+ * @brief Configuration of a PeriodicExecutor
+ */
+struct ExecutorOptions {
+    ExecutorStrategy strategy = ExecutorStrategy::Auto;
+    ClockSourceKind clockKind = ClockSourceKind::Auto;  ///< BusySpin only
+    std::chrono::nanoseconds spinMargin{0};  ///< SleepSpin, 0 is adaptive
+    SpinPolicy spinPolicy = SpinPolicy::Auto;  ///< Between spin polls
+    RealtimeOptions realtime;
+};
+
+/**
+ * @brief Counters of a running or stopped executor
+ */
+struct ExecutorStats {
+    std::uint64_t ticks;         ///< Callbacks invoked
+    std::uint64_t overruns;      ///< Callbacks that ran past the next deadline
+    std::uint64_t skippedTicks;  ///< Deadlines dropped because of overruns
+    std::chrono::nanoseconds longestCallback;
+    std::chrono::nanoseconds maxLateness;
+};
+
+/**
+ * @brief Invokes a callback at a fixed period on a dedicated thread
+ *
+ * Deadlines sit on a fixed grid anchored at start(), so the cadence does
+ * not drift. Each deadline is waited for with the Timer (sleep then spin,
+ * with an adaptive spin margin) or HighResTimer (pure busy-wait) strategy.
+ * A callback that runs past the next deadline is counted as an overrun and
+ * the deadlines it covered are skipped rather than fired back to back.
+ *
+ * Nothing is allocated per tick: the callback is stored once and lateness
+ * goes into a preallocated histogram. Exceptions thrown by the callback
+ * stop the executor and are rethrown by stop().
+ */
+class PeriodicExecutor {
+public:
+    using Callback = std::function<void(const TickInfo&)>;
+
+    /**
+     * @param period Time between deadlines
+     * @param callback Invoked on the executor thread at every deadline
+     * @param options Wait strategy, clock and real-time settings
+     * @throws std::invalid_argument if period is not positive or callback is
+     * empty
+     */
+    PeriodicExecutor(std::chrono::nanoseconds period, Callback callback,
+                     const ExecutorOptions& options = {});
+
+    /** @brief Stops the executor, discarding any callback exception */
+    ~PeriodicExecutor();
+
+    PeriodicExecutor(const PeriodicExecutor&)            = delete;
+    PeriodicExecutor& operator=(const PeriodicExecutor&) = delete;
+
+    /**
+     * @brief Reset the counters and start ticking one period from now
+     * @throws std::logic_error if already running
+     */
+    void start();
+
+    /**
+     * @brief Stop after the current wait or callback and join the thread;
+     * a sleeping Timer-strategy wait finishes first, so this can take up to
+     * one period
+     * @throws The exception thrown by the callback, if any
+     */
+    void stop();
+
+    /** @brief true between start() and the thread finishing */
+    bool running() const {
+        return running_.load(std::memory_order_acquire);
+    }
+
+    /** @brief Consistent only field by field while running */
+    ExecutorStats stats() const;
+
+    /** @brief Callback start lateness in nanoseconds; read after stop() */
+    const LatencyHistogram& latenessHistogram() const {
+        return lateness_;
+    }
+
+    /** @brief Sleep/spin split of the SleepSpin strategy; read after stop() */
+    AdaptiveSpinScheduler::Report schedulerReport() const {
+        return sleepWait_.report();
+    }
+
+    /** @brief Real-time steps applied and skipped; read after stop() */
+    const RealtimeReport& realtimeReport() const {
+        return realtimeReport_;
+    }
+
+    ExecutorStrategy strategy() const {
+        return strategy_;
+    }
+
+private:
+    void loop();
+    void waitUntil(std::chrono::steady_clock::time_point deadline);
+
+    std::chrono::nanoseconds period_;
+    Callback callback_;
+    ExecutorStrategy strategy_;
+    RealtimeOptions realtime_;
+    ClockSource clock_;
+    SleepSpinWait sleepWait_;
+    BusySpinWait busyWait_;
+    LatencyHistogram lateness_;
+    RealtimeReport realtimeReport_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stopRequested_{false};
+    std::exception_ptr error_;
+
+    // Written by the executor thread only
+    std::atomic<std::uint64_t> ticks_{0};
+    std::atomic<std::uint64_t> overruns_{0};
+    std::atomic<std::uint64_t> skippedTicks_{0};
+    std::atomic<std::int64_t> longestCallbackNs_{0};
+    std::atomic<std::int64_t> maxLatenessNs_{0};
+};
+
+}  // namespace ts
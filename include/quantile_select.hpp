@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Exact percentiles of unsorted samples without sorting them
+ *
+ * Ranks follow utils::calculatePercentile: the value at floor(p * count) of
+ * the sorted data, clamped to the last sample. Small inputs are copied into
+ * a scratch buffer and the percentiles selected in ascending rank order by
+ * successive nth_element calls, each on the partition right of the previous
+ * rank. From kParallelThreshold samples on (and for up to 16 percentiles
+ * per call), worker threads instead narrow every rank down by counting the
+ * samples into 2^16 buckets per pass: after a pass for the value range, a
+ * range of up to 2^48 ns (about three days) is resolved in three counting
+ * passes, without copying the data.
+ *
+ * Scratch and bucket storage is kept between calls, so selecting on
+ * captures of similar size does not allocate. Not thread-safe.
+ */
+class QuantileSelector {
+public:
+    /** @brief Sample count from which the parallel path is taken */
+    static constexpr std::size_t kParallelThreshold = std::size_t(1) << 22;
+
+    /**
+     * @param threads Worker threads for large inputs, including the calling
+     * thread; 0 uses std::thread::hardware_concurrency()
+     */
+    explicit QuantileSelector(unsigned int threads = 0);
+
+    /**
+     * @brief Select several percentiles in one call
+     * @param data Samples; not modified
+     * @param count Number of samples
+     * @param fractions Percentile fractions (0.0 to 1.0) in any order
+     * @param fractionCount Number of fractions
+     * @param out Receives the value of each fraction, in the same order
+     * @throws std::invalid_argument if count is 0
+     */
+    void select(const std::int64_t* data, std::size_t count,
+                const double* fractions, std::size_t fractionCount,
+                std::int64_t* out);
+
+    /** @brief Single percentile; prefer select() for several */
+    std::int64_t select(const std::vector<std::int64_t>& data,
+                        double fraction);
+
+    unsigned int threads() const {
+        return threads_;
+    }
+
+private:
+    struct Target {
+        std::size_t fraction;  // Index into the caller's arrays
+        std::uint64_t rank;    // Within the target's current range
+        std::size_t range;     // Index into ranges_
+        bool resolved;
+    };
+
+    struct Range {
+        std::int64_t low;
+        int shift;  // log2 of the bucket width
+    };
+
+    void selectSequential(const std::int64_t* data, std::size_t count,
+                          std::int64_t* out);
+    void selectParallel(const std::int64_t* data, std::size_t count,
+                        std::int64_t* out);
+
+    unsigned int threads_;
+    std::vector<std::int64_t> scratch_;
+    std::vector<std::uint64_t> counts_;  // [thread][range][bucket]
+    std::vector<Target> targets_;
+    std::vector<Range> ranges_;
+    std::vector<Range> nextRanges_;
+};
+
+}  // namespace ts
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Linux real-time execution settings for a timer run
+ *
+ * When enabled, the timing thread sleeps with clock_nanosleep(TIMER_ABSTIME)
+ * on absolute deadlines, its timer slack is reduced to 1ns and all process
+ * memory is locked with mlockall (once per process, however many guards
+ * are alive). SCHED_FIFO and CPU pinning are optional.
+ * Every step degrades gracefully: a step that fails (usually for lack of
+ * CAP_SYS_NICE / CAP_IPC_LOCK or RLIMIT_MEMLOCK) is reported and skipped.
+ */
+struct RealtimeOptions {
+    bool enabled     = false;
+    int fifoPriority = 0;   ///< SCHED_FIFO priority (1-99), 0 keeps CFS
+    int timingCpu    = -1;  ///< CPU for the timing thread, -1 leaves it free
+    int outputCpu    = -1;  ///< CPU for the output thread, -1 leaves it free
+};
+
+/**
+ * @brief Which real-time steps took effect, for the run report
+ */
+struct RealtimeReport {
+    std::vector<std::string> applied;
+    std::vector<std::string> skipped;  ///< Each entry includes the reason
+};
+
+/**
+ * @brief Applies RealtimeOptions to the calling (timing) thread for the
+ * lifetime of the guard and restores scheduling policy, CPU affinity and
+ * timer slack afterwards
+ */
+class RealtimeGuard {
+public:
+    /**
+     * @param sleeps Whether the thread's wait sleeps, and so uses
+     * sleepUntilAbsolute(); reported only then
+     */
+    RealtimeGuard(const RealtimeOptions& options, RealtimeReport& report,
+                  bool sleeps);
+    ~RealtimeGuard();
+
+    RealtimeGuard(const RealtimeGuard&)            = delete;
+    RealtimeGuard& operator=(const RealtimeGuard&) = delete;
+
+private:
+    struct SavedState;
+    std::unique_ptr<SavedState> saved_;
+};
+
+/**
+ * @brief Pin the calling thread to one CPU
+ * @param cpu CPU index
+ * @param error Receives the reason on failure
+ * @return true on success
+ */
+bool pinCurrentThread(int cpu, std::string& error);
+
+/**
+ * @brief Sleep until an absolute system_clock deadline, using
+ * clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME) on Linux
+ */
+void sleepUntilAbsolute(std::chrono::system_clock::time_point deadline);
+
+/**
+ * @brief Sleep until an absolute steady_clock deadline, using
+ * clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME) on Linux
+ */
+void sleepUntilAbsolute(std::chrono::steady_clock::time_point deadline);
+
+}  // namespace ts
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Huge page backing requested for a RunArena
+ */
+enum class HugePages {
+    None,         ///< Regular pages
+    Transparent,  ///< madvise(MADV_HUGEPAGE), if THP is not disabled
+    Explicit      ///< MAP_HUGETLB from the reserved pool
+};
+
+/**
+ * @brief Parse a --huge-pages value: "none", "thp" or "hugetlb"
+ * @throws std::invalid_argument on any other value
+ */
+HugePages parseHugePages(const std::string& text);
+
+const char* hugePagesName(HugePages pages);
+
+/**
+ * @brief Whether, and how, a timer places its per-run buffers in a
+ * RunArena
+ */
+struct RunArenaOptions {
+    bool enabled        = false;
+    HugePages hugePages = HugePages::None;
+};
+
+/**
+ * @brief Page faults taken by the calling thread so far
+ */
+struct PageFaults {
+    bool available      = false;  ///< false where getrusage is missing
+    std::uint64_t minor = 0;
+    std::uint64_t major = 0;
+};
+
+/** @brief Page fault counters of the calling thread */
+PageFaults threadPageFaults();
+
+/**
+ * @brief Bump allocator over one mapping that is faulted in and locked
+ * before a run starts
+ *
+ * std::vector::reserve() and plain operator new only reserve address
+ * space; the first store to every page then faults inside the timed loop.
+ * The arena maps its whole block at construction, optionally backed by
+ * huge pages, writes every page and mlocks the block, so that nothing
+ * handed out by allocate() can fault during the run. Locking degrades
+ * like the real-time steps do: a failure (usually RLIMIT_MEMLOCK) is
+ * reported and the block stays prefaulted but swappable. An explicit huge
+ * page request that the pool cannot satisfy falls back to transparent
+ * huge pages.
+ *
+ * Individual allocations are never freed; reset() hands the whole block
+ * out again for the next run.
+ */
+class RunArena {
+public:
+    /** @brief Alignment of every allocation, one cache line */
+    static constexpr std::size_t kAlignment = 64;
+
+    /**
+     * @param bytes Usable size; rounded up to whole (huge) pages
+     * @param hugePages Requested backing
+     * @throws std::bad_alloc if the block cannot be mapped
+     */
+    RunArena(std::size_t bytes, HugePages hugePages);
+    ~RunArena();
+
+    RunArena(const RunArena&)            = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    /**
+     * @brief Carve bytes, aligned to kAlignment, from the block
+     * @throws std::bad_alloc if the block is exhausted
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Make the whole block available again and lock it anew, since
+     * a munlockall elsewhere in the process drops the arena's lock too
+     */
+    void reset();
+
+    /** @brief Space allocate() takes for bytes, alignment included */
+    static std::size_t footprint(std::size_t bytes) {
+        return (bytes + kAlignment - 1) & ~(kAlignment - 1);
+    }
+
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+    std::size_t used() const {
+        return used_;
+    }
+
+    /** @brief Backing actually obtained */
+    HugePages hugePages() const {
+        return hugePages_;
+    }
+
+    bool locked() const {
+        return locked_;
+    }
+
+    /** @brief Why the last attempt to lock the block failed, or empty */
+    const std::string& lockError() const {
+        return lockError_;
+    }
+
+    /**
+     * @brief Why the requested huge pages were not obtained; empty if they
+     * were
+     */
+    const std::vector<std::string>& warnings() const {
+        return warnings_;
+    }
+
+private:
+    void lock();
+    void prefault();
+
+    unsigned char* base_ = nullptr;
+    std::size_t mapped_  = 0;  // Length of the mapping
+    std::size_t capacity_;
+    std::size_t used_ = 0;
+    HugePages hugePages_;
+    bool locked_ = false;
+    std::string lockError_;
+    std::vector<std::string> warnings_;
+};
+
+/**
+ * @brief Standard allocator that carves from a RunArena, or falls back to
+ * operator new without one
+ *
+ * Deallocation is a no-op for arena memory. The allocator moves with its
+ * container, so assigning a container built on a new arena rebinds it.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type                             = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(RunArena* arena) noexcept : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.arena()) {}
+
+    T* allocate(std::size_t n) {
+        if (arena_ != nullptr) {
+            return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        if (arena_ == nullptr) {
+            ::operator delete(p);
+        }
+    }
+
+    RunArena* arena() const noexcept {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == other.arena();
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ != other.arena();
+    }
+
+private:
+    RunArena* arena_ = nullptr;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace ts
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ts {
+
+/**
+ * @brief Dispersion of a run of raw samples, from a single pass over them
+ */
+struct SampleSummary {
+    std::size_t count;
+    double mean;
+    double stddev;            ///< Population standard deviation
+    std::int64_t min;
+    std::int64_t max;
+    double meanAbsDeviation;  ///< Mean of |sample - target|
+    std::int64_t maxJitter;   ///< Largest |sample[i] - sample[i - 1]|
+};
+
+/**
+ * @brief Summarize samples in one vectorized pass
+ *
+ * Every statistic is accumulated in the same pass over memory, with AVX2
+ * when the CPU supports it, SSE2 on other x86-64 CPUs and scalar code
+ * elsewhere. Samples are converted to double exactly and accumulated as
+ * deviations from the target, which keeps the variance free of
+ * cancellation when the samples sit close to it.
+ *
+ * @param samples Values in [0, 2^52), e.g. interval nanoseconds
+ * @param count Number of samples
+ * @param targetNs Reference for the deviations, e.g. the timer interval
+ * @throws std::invalid_argument if count is 0
+ */
+SampleSummary summarizeSamples(const std::int64_t* samples, std::size_t count,
+                               std::int64_t targetNs);
+
+/** @brief Kernel summarizeSamples() runs on: "avx2", "sse2" or "scalar" */
+const char* sampleKernelName();
+
+}  // namespace ts
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "histogram.hpp"
+
+namespace ts {
+
+/**
+ * @brief One reporting window of a soak run
+ */
+struct SoakWindow {
+    std::chrono::nanoseconds length;
+    bool rolling = false;  ///< Slide in tenths of length instead of tumbling
+};
+
+/**
+ * @brief Parse a comma-separated window list such as "1s,1m,1h"
+ * @param list Lengths with an ms, s, m (or min) or h suffix; a bare number
+ * is in seconds
+ * @param rolling Make every window a rolling one
+ * @throws std::invalid_argument on an empty, malformed or non-positive
+ * length
+ */
+std::vector<SoakWindow> parseSoakWindows(const std::string& list,
+                                         bool rolling);
+
+/**
+ * @brief Windowed interval statistics for long-running timers
+ *
+ * Fed from the output thread with the same records the per-tick printer
+ * gets, so no aggregation work happens on the timing thread. Windows are
+ * aligned to the run's start timestamp and closed by the timestamps of the
+ * records themselves, which keeps the reports independent of when the
+ * output thread gets to run.
+ *
+ * A tumbling window reports once per length. A rolling window keeps
+ * kRollingSlices sub-histograms in a ring and, at the end of every slice,
+ * reports the merge of the last kRollingSlices slices. Every histogram is
+ * allocated in the constructor, so memory stays constant however long the
+ * run lasts.
+ */
+class SoakAggregator {
+public:
+    static constexpr int kRollingSlices = 10;
+
+    /** @brief Histogram precision of the windows (about 0.4% error) */
+    static constexpr int kHistogramBits = 9;
+
+    /**
+     * @param windows Windows to report
+     * @param unit Display unit label
+     * @param nanosecondsPerUnit Scale of the display unit
+     * @param dropped Counter of records that never reached the aggregator;
+     * each report includes its increase since the track's previous report
+     * @throws std::invalid_argument if windows is empty
+     */
+    SoakAggregator(const std::vector<SoakWindow>& windows, const char* unit,
+                   double nanosecondsPerUnit,
+                   const std::atomic<std::uint64_t>& dropped);
+
+    SoakAggregator(const SoakAggregator&)            = delete;
+    SoakAggregator& operator=(const SoakAggregator&) = delete;
+
+    /** @brief Clear every window and align them to the run's start */
+    void start(std::int64_t startNs);
+
+    /**
+     * @brief Add one interval, first logging every window that closed
+     * before timestampNs
+     */
+    void add(std::int64_t timestampNs, std::int64_t intervalNs);
+
+    /** @brief Log the windows still open at the end of the run as partial */
+    void finish();
+
+private:
+    struct Track {
+        SoakWindow window;
+        std::int64_t sliceNs;
+        std::vector<LatencyHistogram> slices;  // Ring, one for tumbling
+        std::size_t current;
+        std::size_t filled;  // Slices holding data of the current window
+        std::int64_t sliceEndNs;
+        std::uint64_t droppedAtStart;
+    };
+
+    void closeSlice(Track& track);
+    void report(Track& track, std::int64_t endNs, bool partial);
+
+    std::vector<Track> tracks_;
+    LatencyHistogram merged_;
+    const char* unit_;
+    double nanosecondsPerUnit_;
+    const std::atomic<std::uint64_t>& dropped_;
+    std::int64_t startNs_ = 0;
+    std::int64_t lastNs_  = 0;
+};
+
+}  // namespace ts
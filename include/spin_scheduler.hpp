@@ -0,0 +1,105 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "histogram.hpp"
+
+namespace ts {
+
+/**
+ * @brief Learns how late sleep_until() wakes up and picks the spin margin
+ *
+ * A sleep-then-spin loop sleeps until deadline - margin and busy-waits for
+ * the rest. The scheduler records every observed oversleep (wake time minus
+ * requested wake time) into two alternating windowed histograms and sets
+ * the margin to the p99 oversleep of the recent windows plus a safety
+ * allowance, clamped to [kMinMargin, interval / 2]. A wake-up that already
+ * missed the deadline doubles the margin immediately, and the percentile
+ * estimate then pulls it back down once the host is quiet again.
+ */
+class AdaptiveSpinScheduler {
+public:
+    /** @brief Margin never drops below this, to absorb clock read jitter */
+    static constexpr std::chrono::nanoseconds kMinMargin{20000};
+
+    /** @brief Samples per window before the windows rotate */
+    static constexpr std::uint64_t kWindowSamples = 512;
+
+    /** @brief Samples required before the learned margin is trusted */
+    static constexpr std::uint64_t kWarmupSamples = 32;
+
+    struct Report {
+        std::uint64_t wakeups;
+        std::uint64_t missedWakeups;  ///< Woke up after the deadline
+        std::chrono::nanoseconds sleepTime;
+        std::chrono::nanoseconds spinTime;
+        std::chrono::nanoseconds finalMargin;
+        std::chrono::nanoseconds p99Oversleep;
+        std::chrono::nanoseconds cpuTime;  ///< Thread CPU time for the run
+        bool adaptive;
+    };
+
+    /**
+     * @param interval Timer period, used to cap the margin at interval / 2
+     */
+    explicit AdaptiveSpinScheduler(std::chrono::nanoseconds interval);
+
+    /**
+     * @brief Disable learning and always use the given margin
+     */
+    void setFixedMargin(std::chrono::nanoseconds margin);
+
+    /**
+     * @brief Retarget to another timer period; a fixed margin is clamped
+     * again against the new cap
+     */
+    void setInterval(std::chrono::nanoseconds interval);
+
+    /** @brief Reset learned state and counters before a run */
+    void begin();
+
+    /** @brief Finish CPU time accounting after a run */
+    void end();
+
+    /** @brief Current spin margin */
+    std::chrono::nanoseconds margin() const {
+        return margin_;
+    }
+
+    /**
+     * @brief Record one sleep/spin cycle
+     * @param sleepTime Time between starting the sleep and waking up
+     * @param oversleep Wake time minus requested wake time
+     * @param spinTime Time spent busy-waiting after waking up
+     * @param missedDeadline true if the wake-up was already past the deadline
+     */
+    void record(std::chrono::nanoseconds sleepTime,
+                std::chrono::nanoseconds oversleep,
+                std::chrono::nanoseconds spinTime, bool missedDeadline);
+
+    Report report() const;
+
+    /** @brief CPU time consumed by the calling thread so far */
+    static std::chrono::nanoseconds threadCpuTime();
+
+private:
+    void updateMargin();
+
+    std::chrono::nanoseconds maxMargin_;
+    std::chrono::nanoseconds margin_;
+    std::chrono::nanoseconds fixedMargin_{0};  // As requested, unclamped
+    bool adaptive_ = true;
+
+    LatencyHistogram windows_[2];
+    int current_ = 0;
+
+    std::uint64_t wakeups_       = 0;
+    std::uint64_t missedWakeups_ = 0;
+    std::chrono::nanoseconds sleepTime_{0};
+    std::chrono::nanoseconds spinTime_{0};
+    std::chrono::nanoseconds cpuStart_{0};
+    std::chrono::nanoseconds cpuTime_{0};
+};
+
+}  // namespace ts
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#define TS_HAVE_MM_PAUSE 1
+#endif
+
+namespace ts {
+
+/**
+ * @brief What a busy-wait does between two polls of the clock
+ */
+enum class SpinPolicy {
+    Auto,    ///< Tpause when the CPU supports it, otherwise Pause
+    Raw,     ///< Poll back to back
+    Pause,   ///< PAUSE instructions, fewer as the deadline approaches
+    Tpause,  ///< TPAUSE (WAITPKG) for part of the remaining time, reporting
+             ///< why it fell back to Pause if unavailable
+    Yield    ///< Yield the CPU while far from the deadline, then Pause
+};
+
+/**
+ * @brief Parse "auto", "raw", "pause", "tpause" or "yield"
+ * @throws std::invalid_argument for any other name
+ */
+SpinPolicy parseSpinPolicy(const std::string& name);
+
+const char* spinPolicyName(SpinPolicy policy);
+
+/** @brief true if CPUID reports WAITPKG (UMONITOR/UMWAIT/TPAUSE) */
+bool cpuHasWaitpkg();
+
+/** @brief One PAUSE (x86) or nothing where there is no equivalent */
+inline void cpuRelax() noexcept {
+#ifdef TS_HAVE_MM_PAUSE
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * @brief Runtime-selected relaxation between the clock polls of a spin
+ *
+ * A bare polling loop keeps the core's issue slots busy, which starves an
+ * SMT sibling and burns power. PAUSE hands those slots to the sibling for
+ * tens of cycles; TPAUSE parks the core in a light C0.1 state until a TSC
+ * deadline. Both are bounded by the time left to the deadline, so the wait
+ * never deliberately sleeps past it. The policy is resolved once, and
+ * relax() costs a predictable switch per poll.
+ */
+class SpinRelax {
+public:
+    /**
+     * @param policy Requested policy; Auto and Tpause resolve to Pause when
+     * TPAUSE is unavailable, Tpause also records fallbackReason()
+     */
+    explicit SpinRelax(SpinPolicy policy = SpinPolicy::Auto);
+
+    /**
+     * @brief Called between two polls
+     * @param remaining Time left to the deadline at the last poll
+     */
+    void relax(std::chrono::nanoseconds remaining) noexcept {
+        switch (policy_) {
+        case SpinPolicy::Raw:
+            return;
+        case SpinPolicy::Tpause:
+            if (remaining >= kMinTpause) {
+                tpauseFor(remaining);
+                return;
+            }
+            break;
+        case SpinPolicy::Yield:
+            if (remaining >= kMinYield) {
+                std::this_thread::yield();
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        pauseFor(remaining);
+    }
+
+    /** @brief The policy in effect, never Auto */
+    SpinPolicy policy() const {
+        return policy_;
+    }
+
+    /** @brief Why a requested Tpause fell back to Pause, or empty */
+    const std::string& fallbackReason() const {
+        return fallbackReason_;
+    }
+
+    /** @brief Human readable description, e.g. "tpause (auto)" */
+    std::string describe() const;
+
+private:
+    /** @brief Below this, TPAUSE's wake-up cost outweighs the sleep */
+    static constexpr std::chrono::nanoseconds kMinTpause{2000};
+
+    /** @brief Below this, a yield risks losing the CPU past the deadline */
+    static constexpr std::chrono::nanoseconds kMinYield{50000};
+
+    /** @brief Upper bound of one PAUSE burst */
+    static constexpr std::int64_t kMaxPauses = 64;
+
+    // About one PAUSE per microsecond left: sparse polls far from the
+    // deadline, back to back polls right before it
+    static void pauseFor(std::chrono::nanoseconds remaining) noexcept {
+        std::int64_t pauses = remaining.count() >> 10;
+        pauses = pauses < 1 ? 1 : (pauses > kMaxPauses ? kMaxPauses : pauses);
+        for (std::int64_t i = 0; i < pauses; ++i) {
+            cpuRelax();
+        }
+    }
+
+    void tpauseFor(std::chrono::nanoseconds remaining) const noexcept;
+
+    SpinPolicy requested_;
+    SpinPolicy policy_;
+    double ticksPerNanosecond_ = 0.0;  // TSC rate for Tpause
+    std::string fallbackReason_;
+};
+
+}  // namespace ts
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace ts {
+
+/** @brief Assumed cache line size used to pad shared ring indices */
+inline constexpr std::size_t kCacheLineSize = 64;
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ * The producer and consumer indices live on separate cache lines, and each
+ * side keeps a private cached copy of the other side's index so that the
+ * common case touches no shared line at all. Neither side ever blocks:
+ * tryPush() fails when the ring is full and consume() returns 0 when empty.
+ *
+ * @tparam T Trivially copyable element type
+ * @tparam Alloc Allocator of the element storage
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class alignas(kCacheLineSize) SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "SpscRing requires a trivially copyable element type");
+
+public:
+    /**
+     * @brief Allocate the ring storage up front
+     * @param capacity Minimum number of elements, rounded up to a power of 2
+     * @param alloc Allocator of the element storage
+     */
+    explicit SpscRing(std::size_t capacity, const Alloc& alloc = Alloc())
+        : capacity_(roundUpPow2(capacity)),
+          mask_(capacity_ - 1),
+          alloc_(alloc),
+          buffer_(std::allocator_traits<Alloc>::allocate(alloc_, capacity_)) {
+        std::uninitialized_value_construct_n(buffer_, capacity_);
+    }
+
+    ~SpscRing() {
+        std::allocator_traits<Alloc>::deallocate(alloc_, buffer_, capacity_);
+    }
+
+    SpscRing(const SpscRing&)            = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Append an element (producer thread only)
+     * @param item The element to append
+     * @return false if the ring is full and the element was not stored
+     */
+    bool tryPush(const T& item) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cachedHead_ == capacity_) {
+            cachedHead_ = head_.load(std::memory_order_acquire);
+            if (tail - cachedHead_ == capacity_) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Hand every available element to a callback (consumer thread
+     * only)
+     * @param fn Callable invoked as fn(const T&) for each element in order
+     * @param maxItems Upper bound on elements consumed in this call
+     * @return Number of elements consumed
+     */
+    template <typename F>
+    std::size_t consume(F&& fn, std::size_t maxItems = ~std::size_t{0}) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (cachedTail_ == head) {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+        }
+        std::size_t available = cachedTail_ - head;
+        if (available > maxItems) {
+            available = maxItems;
+        }
+        for (std::size_t i = 0; i < available; ++i) {
+            fn(buffer_[(head + i) & mask_]);
+        }
+        if (available > 0) {
+            head_.store(head + available, std::memory_order_release);
+        }
+        return available;
+    }
+
+    /** @brief Approximate number of queued elements (any thread) */
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) -
+               head_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    static std::size_t roundUpPow2(std::size_t n) {
+        std::size_t p = 1;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    const std::size_t capacity_;
+    const std::size_t mask_;
+    Alloc alloc_;
+    T* const buffer_;
+
+    // Consumer-owned line
+    alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};
+    std::size_t cachedTail_ = 0;
+
+    // Producer-owned line
+    alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};
+    std::size_t cachedHead_ = 0;
+};
+
+}  // namespace ts
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ts {
+
+/**
+ * @brief Kind of load a stressor thread puts on the machine
+ */
+enum class StressorKind {
+    Spin,     ///< Integer arithmetic, competing for an SMT sibling's core
+    Memory,   ///< Copies between two large buffers, using memory bandwidth
+    Cache,    ///< Scattered writes over a last-level-cache-sized buffer
+    Syscall,  ///< Back-to-back cheap system calls
+    Alloc     ///< malloc/free of sizes up to 256 KiB, some through mmap
+};
+
+/**
+ * @brief Parse "spin", "memory", "cache", "syscall" or "alloc"
+ * @throws std::invalid_argument for any other name
+ */
+StressorKind parseStressorKind(const std::string& name);
+
+const char* stressorKindName(StressorKind kind);
+
+/**
+ * @brief One group of identical stressor threads and where they run
+ */
+struct StressorSpec {
+    StressorKind kind = StressorKind::Spin;
+    int threads       = 1;
+    std::vector<int> cpus;  ///< Pinned round-robin; empty leaves them free
+    bool sibling = false;   ///< Pin to the SMT siblings of the timing CPU
+    std::string label;      ///< The spec as given, for reports
+};
+
+/**
+ * @brief Parse "kind[:threads][@placement]", where placement is a CPU list
+ * such as "2,4-5" or "sibling", e.g. "memory:2@4-5" or "spin@sibling"
+ * @throws std::invalid_argument on malformed input
+ */
+StressorSpec parseStressorSpec(const std::string& spec);
+
+/**
+ * @brief SMT siblings of a CPU, without the CPU itself
+ * @return Empty without SMT or where the topology cannot be read
+ */
+std::vector<int> smtSiblingsOf(int cpu);
+
+/**
+ * @brief Threads generating one kind of load until stopped
+ *
+ * Every thread allocates and first touches its buffers itself, on its own
+ * CPU, and counts the work it gets done so that the report can show how
+ * much load was actually applied.
+ */
+class StressorGroup {
+public:
+    /**
+     * @param spec Kind, thread count and placement; a sibling placement
+     * must already be resolved into cpus
+     */
+    explicit StressorGroup(const StressorSpec& spec);
+
+    /** @brief Stops the threads if still running */
+    ~StressorGroup();
+
+    StressorGroup(const StressorGroup&)            = delete;
+    StressorGroup& operator=(const StressorGroup&) = delete;
+
+    void start();
+
+    /**
+     * @brief Stop and join the threads
+     * @return Work done per second since start(), in rateUnit()
+     */
+    double stop();
+
+    /** @brief Unit of stop()'s rate, e.g. "GB/s" */
+    const char* rateUnit() const;
+
+    const StressorSpec& spec() const {
+        return spec_;
+    }
+
+    /** @brief Reasons threads could not be pinned, empty if all were */
+    const std::vector<std::string>& pinErrors() const {
+        return pinErrors_;
+    }
+
+private:
+    // A cache line per thread, so that the counters of a group do not
+    // bounce between its own threads
+    struct alignas(64) WorkCounter {
+        std::atomic<std::uint64_t> done{0};
+        std::atomic<std::uint64_t> sink{0};  // Keeps computed values live
+    };
+
+    void work(std::size_t thread);
+
+    StressorSpec spec_;
+    std::vector<std::thread> threads_;
+    std::vector<std::string> pinErrors_;
+    std::mutex pinErrorMutex_;
+    std::unique_ptr<WorkCounter[]> work_;
+    std::atomic<bool> stop_{false};
+    std::int64_t startNs_ = 0;
+};
+
+}  // namespace ts
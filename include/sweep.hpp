@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "options.hpp"
+#include "timer_factory.hpp"
+#include "utils.hpp"
+
+namespace ts {
+
+/**
+ * @brief Parse the intervals of a sweep, in seconds
+ * @param spec A comma-separated list such as "0.0001,0.001", or
+ * "start:stop:count" for count log-spaced intervals from start to stop
+ * inclusive
+ * @throws std::invalid_argument on malformed input or a non-positive
+ * interval
+ */
+std::vector<double> parseSweepIntervals(const std::string& spec);
+
+/**
+ * @brief Parse a comma-separated list of positive iteration counts
+ * @throws std::invalid_argument on malformed input or a zero count
+ */
+std::vector<std::size_t> parseSweepIterations(const std::string& list);
+
+/**
+ * @brief Statistics of one sweep step, all in microseconds so that the
+ * steps of both timers line up in one table
+ */
+struct SweepResult {
+    double intervalSec;
+    std::size_t iterations;  ///< Requested
+    const char* timer;       ///< "Timer" or "HighResTimer"
+    ::utils::TimingStats stats;
+};
+
+/**
+ * @brief Runs every interval and iteration count of a sweep in one process
+ *
+ * Each step runs on the calling thread with per-tick output off, so no
+ * output thread is started, and at most one Timer and one HighResTimer are
+ * ever created: later steps retarget them with setInterval(), reusing
+ * their histogram, raw interval storage, clock and wait strategy. Every
+ * step picks its timer like a single run would, unless options.timerKind
+ * forces one.
+ */
+class SweepRunner {
+public:
+    /**
+     * @param options Timer settings shared by every step, with
+     * sweepIntervals and sweepIterations set
+     * @throws std::invalid_argument if either list is empty
+     */
+    explicit SweepRunner(const Options& options);
+
+    /**
+     * @brief Run every step in order, logging progress
+     * @return Results of the steps that collected intervals; a stop request
+     * ends the current step early and skips the rest
+     */
+    std::vector<SweepResult> run();
+
+    /** @brief Ask run() to return soon; async-signal-safe */
+    void requestStop();
+
+private:
+    BaseTimer& retarget(AnyTimer& timer, double intervalSec);
+
+    Options options_;
+    std::optional<AnyTimer> sleepSpinTimer_;
+    std::optional<AnyTimer> busySpinTimer_;
+    std::atomic<BaseTimer*> current_{nullptr};
+    std::atomic<bool> stopRequested_{false};
+};
+
+/** @brief Log the results as one table */
+void printSweepTable(const std::vector<SweepResult>& results);
+
+/**
+ * @brief Write the results as CSV, or as JSON if path ends in .json
+ * @throws std::runtime_error if the file cannot be written
+ */
+void writeSweepReport(const std::vector<SweepResult>& results,
+                      const std::string& path);
+
+}  // namespace ts
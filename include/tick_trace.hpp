@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ts {
+
+/**
+ * @brief Phase sink of a wait strategy when tracing is compiled out; every
+ * call inlines to nothing
+ */
+struct NoTickPhases {
+    template <typename TimePoint>
+    void onWake(TimePoint) noexcept {}
+
+    void onSpin() noexcept {}
+};
+
+/**
+ * @brief Phases of one wait, filled in by a wait strategy for the tick
+ * trace
+ */
+struct TickPhases {
+    std::int64_t wokeNs = 0;  ///< Sleep return (spin start), clock epoch
+    std::uint64_t spins = 0;  ///< Clock polls that found the deadline ahead
+
+    template <typename TimePoint>
+    void onWake(TimePoint woke) noexcept {
+        wokeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     woke.time_since_epoch())
+                     .count();
+    }
+
+    void onSpin() noexcept {
+        ++spins;
+    }
+};
+
+/**
+ * @brief Per-tick phase trace of a timer run (-DTIMESTAMP_ENABLE_TRACE=ON)
+ *
+ * Struct of arrays: one array per field, each starting on its own cache
+ * line, all carved from a single block. The block is sized before the run
+ * and never grows; ticks beyond the capacity are counted, not recorded.
+ * record() is a handful of stores with no branch other than the capacity
+ * check.
+ */
+class TickTrace {
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    /** @brief Default cap on traced ticks (about 40 MiB) */
+    static constexpr std::size_t kDefaultLimit = 1u << 20;
+
+    TickTrace() = default;
+    ~TickTrace();
+
+    TickTrace(const TickTrace&)            = delete;
+    TickTrace& operator=(const TickTrace&) = delete;
+
+    /**
+     * @brief Clear the trace and make room for capacity ticks, reusing the
+     * block if it is already large enough
+     */
+    void reset(std::size_t capacity);
+
+    /**
+     * @brief Clear the trace and lay it out in a caller's block, which
+     * must outlive the trace's use and hold blockBytes(capacity) bytes
+     * aligned to kCacheLine
+     */
+    void reset(std::size_t capacity, void* block);
+
+    /** @brief Size of the block holding capacity ticks */
+    static std::size_t blockBytes(std::size_t capacity);
+
+    /** @brief Timestamp the trace's timeline starts at, in the clock epoch */
+    void setStart(std::int64_t startNs) {
+        startNs_ = startNs;
+    }
+
+    /**
+     * @param deadlineNs Deadline of the tick
+     * @param phases Sleep return and spin count of the wait
+     * @param observedNs Timestamp the wait returned
+     * @param enqueueNs Time spent recording and enqueueing the tick
+     */
+    void record(std::int64_t deadlineNs, const TickPhases& phases,
+                std::int64_t observedNs, std::int64_t enqueueNs) noexcept {
+        if (size_ == capacity_) {
+            ++overflow_;
+            return;
+        }
+        deadlineNs_[size_] = deadlineNs;
+        wokeNs_[size_]     = phases.wokeNs;
+        spins_[size_]      = phases.spins;
+        observedNs_[size_] = observedNs;
+        enqueueNs_[size_]  = enqueueNs;
+        ++size_;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    std::size_t capacity() const {
+        return capacity_;
+    }
+
+    /** @brief Ticks not recorded because the trace was full */
+    std::uint64_t overflowCount() const {
+        return overflow_;
+    }
+
+    /**
+     * @brief Write the trace as Chrome trace event JSON (chrome://tracing,
+     * Perfetto): sleep, spin and enqueue slices per tick, a deadline marker
+     * and a lateness counter, on a timeline starting at setStart()
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void writeChromeTrace(const std::string& path,
+                          const char* clockName) const;
+
+private:
+    void release();
+    void carve(void* block, std::size_t capacity);
+
+    void* block_              = nullptr;  // Owned; null for a caller's block
+    std::int64_t* deadlineNs_ = nullptr;
+    std::int64_t* wokeNs_     = nullptr;
+    std::uint64_t* spins_     = nullptr;
+    std::int64_t* observedNs_ = nullptr;
+    std::int64_t* enqueueNs_  = nullptr;
+    std::size_t size_         = 0;
+    std::size_t capacity_     = 0;
+    std::uint64_t overflow_   = 0;
+    std::int64_t startNs_     = 0;
+};
+
+}  // namespace ts
@@ -1,20 +1,16 @@
 #pragma once
 
-#include <chrono>
-#include <cstddef>
-
-#include "base_timer.hpp"
+#include "basic_timer.hpp"
+#include "timer_policies.hpp"
 
 namespace ts {
 
-class Timer : public BaseTimer {
-public:
-    explicit Timer(double intervalSec);
-
-    void run(std::size_t iterations = 100) override;
+/**
+ * @brief Sleep-then-spin timer on system_clock, reporting milliseconds;
+ * used for intervals of kHighResThresholdSec and above
+ */
+using Timer = BasicTimer<SystemClock, Milliseconds, SleepSpinWait>;
 
-private:
-    std::chrono::system_clock::time_point lastTimePoint_;
-};
+extern template class BasicTimer<SystemClock, Milliseconds, SleepSpinWait>;
 
 }  // namespace ts
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <memory>
+#include <variant>
+
+#include "base_timer.hpp"
+#include "high_res_timer.hpp"
+#include "options.hpp"
+#include "timer.hpp"
+
+namespace ts {
+
+/**
+ * @brief One of the pre-instantiated timer specializations; use std::visit
+ * to run it with static dispatch
+ */
+using AnyTimer =
+    std::variant<std::unique_ptr<Timer>, std::unique_ptr<HighResTimer>>;
+
+/**
+ * @brief true if createTimer() picks HighResTimer: the one asked for by
+ * options.timerKind, else the one suited to options.intervalSec
+ */
+bool usesHighResTimer(const Options& options);
+
+/**
+ * @brief Create the timer picked by usesHighResTimer() and apply the clock,
+ * spin margin and real-time settings from the options
+ */
+AnyTimer createTimer(const Options& options);
+
+/** @brief The specialization-independent part of a timer */
+inline BaseTimer& baseTimer(const AnyTimer& timer) {
+    return std::visit([](const auto& t) -> BaseTimer& { return *t; }, timer);
+}
+
+}  // namespace ts
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "realtime.hpp"
+#include "spin_scheduler.hpp"
+#include "spin_wait.hpp"
+#include "tick_trace.hpp"
+
+namespace ts {
+
+// ---------------------------------------------------------------------------
+// Units: the display unit of a timer, fixed at compile time. The hot loop
+// only handles integer nanoseconds; the factor is applied at report time.
+// ---------------------------------------------------------------------------
+
+struct Milliseconds {
+    static constexpr const char* kLabel        = "ms";
+    static constexpr std::int64_t kNanoseconds = 1000000;
+};
+
+struct Microseconds {
+    static constexpr const char* kLabel        = "us";
+    static constexpr std::int64_t kNanoseconds = 1000;
+};
+
+// ---------------------------------------------------------------------------
+// Clocks: anything with time_point, now(), resyncIfDue(), name() and
+// describe().
+// ClockSource (steady_clock or TSC) is the other clock in use.
+// ---------------------------------------------------------------------------
+
+/** @brief std::chrono::system_clock as a timer clock policy */
+struct SystemClock {
+    using time_point = std::chrono::system_clock::time_point;
+
+    time_point now() const noexcept {
+        return std::chrono::system_clock::now();
+    }
+
+    /** @brief Nothing to keep in step */
+    bool resyncIfDue(time_point) {
+        return false;
+    }
+
+    const char* name() const {
+        return "system_clock";
+    }
+
+    /** @brief Nothing worth reporting beyond the name */
+    std::string describe() const {
+        return {};
+    }
+};
+
+/**
+ * @brief Intervals below this busy-wait (HighResTimer, BusySpinWait); the
+ * rest sleep first (Timer, SleepSpinWait)
+ */
+inline constexpr double kHighResThresholdSec = 0.002;
+
+// ---------------------------------------------------------------------------
+// Wait strategies: how the loop gets from one deadline to the next.
+// waitUntil() returns a clock reading taken at or after the deadline and
+// reports its phases to a TickPhases (tracing) or NoTickPhases sink. The
+// spinning part relaxes between polls according to a runtime SpinPolicy.
+// ---------------------------------------------------------------------------
+
+/**
+ * @brief Sleep until shortly before the deadline, then spin; the margin is
+ * learned by an AdaptiveSpinScheduler (the Timer strategy)
+ */
+class SleepSpinWait {
+public:
+    /** @brief Run at above-normal priority on Windows */
+    static constexpr bool kHighestPriority = false;
+
+    /** @brief Sleeps, with sleepUntilAbsolute() in real-time mode */
+    static constexpr bool kSleeps = true;
+
+    explicit SleepSpinWait(std::chrono::nanoseconds interval)
+        : scheduler_(interval) {}
+
+    /**
+     * @brief Use a fixed spin margin instead of learning it from observed
+     * wake-up lateness
+     */
+    void setFixedMargin(std::chrono::nanoseconds margin) {
+        scheduler_.setFixedMargin(margin);
+    }
+
+    void setSpinPolicy(SpinPolicy policy) {
+        spin_ = SpinRelax(policy);
+    }
+
+    const SpinRelax& spinRelax() const {
+        return spin_;
+    }
+
+    void setInterval(std::chrono::nanoseconds interval) {
+        scheduler_.setInterval(interval);
+    }
+
+    AdaptiveSpinScheduler::Report report() const {
+        return scheduler_.report();
+    }
+
+    template <typename Clock>
+    void begin(const Clock&) {
+        scheduler_.begin();
+    }
+
+    void end() {
+        scheduler_.end();
+    }
+
+    /**
+     * @param last Timestamp of the previous tick, standing in for the sleep
+     * start to avoid another clock read
+     * @param absoluteSleep Sleep with clock_nanosleep(TIMER_ABSTIME)
+     */
+    template <typename Clock, typename Deadline,
+              typename Phases = NoTickPhases>
+    typename Clock::time_point waitUntil(const Clock& clock,
+                                         typename Clock::time_point last,
+                                         Deadline deadline,
+                                         bool absoluteSleep,
+                                         Phases&& phases = Phases()) {
+        using std::chrono::duration_cast;
+        using std::chrono::nanoseconds;
+
+        auto wakeTarget = deadline - scheduler_.margin();
+        if (wakeTarget <= last) {
+            // Already inside the spin window, e.g. right after an overrun;
+            // the sleep would return at once and skew the learned margin
+            auto now = clock.now();
+            phases.onWake(now);
+            return spinUntil(clock, now, deadline, phases);
+        }
+        if (absoluteSleep) {
+            sleepUntilAbsolute(wakeTarget);
+        } else {
+            std::this_thread::sleep_until(wakeTarget);
+        }
+
+        auto woke = clock.now();
+        phases.onWake(woke);
+        auto now = spinUntil(clock, woke, deadline, phases);
+
+        scheduler_.record(duration_cast<nanoseconds>(woke - last),
+                          duration_cast<nanoseconds>(woke - wakeTarget),
+                          duration_cast<nanoseconds>(now - woke),
+                          woke >= deadline);
+        return now;
+    }
+
+    /** @brief Log the spin margin, spin policy and sleep/spin split */
+    void printDetails() const;
+
+private:
+    template <typename Clock, typename Deadline, typename Phases>
+    typename Clock::time_point spinUntil(const Clock& clock,
+                                         typename Clock::time_point now,
+                                         Deadline deadline, Phases& phases) {
+        while (now < deadline) {
+            phases.onSpin();
+            spin_.relax(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - now));
+            now = clock.now();
+        }
+        return now;
+    }
+
+    AdaptiveSpinScheduler scheduler_;
+    SpinRelax spin_;
+};
+
+/**
+ * @brief Busy-wait on the clock for the whole interval (the HighResTimer
+ * strategy)
+ */
+class BusySpinWait {
+public:
+    /** @brief Run at the highest priority on Windows */
+    static constexpr bool kHighestPriority = true;
+
+    /** @brief Never sleeps */
+    static constexpr bool kSleeps = false;
+
+    explicit BusySpinWait(std::chrono::nanoseconds) {}
+
+    void setSpinPolicy(SpinPolicy policy) {
+        spin_ = SpinRelax(policy);
+    }
+
+    const SpinRelax& spinRelax() const {
+        return spin_;
+    }
+
+    /** @brief Nothing depends on the interval */
+    void setInterval(std::chrono::nanoseconds) {}
+
+    /** @brief Warm up to stabilize CPU frequency and cache */
+    template <typename Clock>
+    void begin(const Clock& clock) {
+        for (int i = 0; i < 1000; ++i) {
+            clock.now();
+        }
+    }
+
+    void end() {}
+
+    template <typename Clock, typename Deadline,
+              typename Phases = NoTickPhases>
+    typename Clock::time_point waitUntil(const Clock& clock,
+                                         typename Clock::time_point,
+                                         Deadline deadline, bool,
+                                         Phases&& phases = Phases()) {
+        auto now = clock.now();
+        phases.onWake(now);
+        while (now < deadline) {
+            phases.onSpin();
+            spin_.relax(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                deadline - now));
+            now = clock.now();
+        }
+        return clock.now();
+    }
+
+    /** @brief Log the spin policy */
+    void printDetails() const;
+
+private:
+    SpinRelax spin_;
+};
+
+}  // namespace ts
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "histogram.hpp"
+#include "spin_scheduler.hpp"
+#include "spin_wait.hpp"
+#include "utils.hpp"
+
+namespace ts {
+
+/**
+ * @brief Hierarchical timing wheel driving many periodic and one-shot
+ * deadlines from a single dispatcher thread
+ *
+ * Deadlines are absolute steady_clock times quantized to a tick resolution.
+ * Four levels of 256 slots cover 2^32 ticks; entries further out than that
+ * are parked in the top level and re-cascaded. Insert and cancel are O(1)
+ * (intrusive doubly linked slot lists over a preallocated entry pool) and
+ * cascading is amortized O(1) per entry. Periodic entries keep a
+ * drift-free cadence by advancing their deadline by exactly one period
+ * after each expiry, as the single-timer run() loops do.
+ *
+ * The dispatcher wakes only for ticks that have expiring entries (or for a
+ * cascade), sleeping until shortly before the tick and spinning for the
+ * rest with an AdaptiveSpinScheduler. Each expiry's lateness (callback start
+ * minus the time of the tick its deadline was rounded up to) is recorded
+ * into the entry's own histogram and into an aggregate histogram; the
+ * rounding itself, up to one tick, is recorded apart as quantization.
+ *
+ * The wheel is not thread-safe: schedule() and cancel() may be called
+ * before run() or from callbacks. stop() may be called from any thread.
+ */
+class TimingWheel {
+public:
+    using Clock    = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+    using TimerId  = std::uint64_t;
+
+    static constexpr TimerId kInvalidTimer = ~TimerId{0};
+
+    /**
+     * @param resolution Tick length; deadlines are rounded up to a tick
+     * @param capacity Maximum number of concurrently scheduled entries
+     * @param histogramBits Precision of every per-entry lateness histogram
+     */
+    TimingWheel(std::chrono::nanoseconds resolution, std::size_t capacity,
+                int histogramBits = 5);
+
+    TimingWheel(const TimingWheel&)            = delete;
+    TimingWheel& operator=(const TimingWheel&) = delete;
+
+    /**
+     * @brief Schedule a callback every period, starting at firstDeadline
+     * @throws std::length_error if the entry pool is exhausted
+     */
+    TimerId schedulePeriodic(Clock::time_point firstDeadline,
+                             std::chrono::nanoseconds period,
+                             Callback callback);
+
+    /**
+     * @brief Schedule a callback once at deadline
+     * @throws std::length_error if the entry pool is exhausted
+     */
+    TimerId scheduleOnce(Clock::time_point deadline, Callback callback);
+
+    /**
+     * @brief Cancel an entry; its lateness statistics stay readable until the
+     * slot is reused
+     * @return false if the entry already expired or was cancelled
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Dispatch expiries on the calling thread until stop() is called
+     * or the wall clock passes until
+     */
+    void run(Clock::time_point until);
+
+    /** @brief Relaxation between clock polls while spinning to a tick */
+    void setSpinPolicy(SpinPolicy policy) {
+        spin_ = SpinRelax(policy);
+    }
+
+    /** @brief Ask run() to return after the current tick */
+    void stop() {
+        stopRequested_.store(true, std::memory_order_relaxed);
+    }
+
+    /** @brief Number of currently scheduled entries */
+    std::size_t activeCount() const {
+        return activeCount_;
+    }
+
+    /** @brief Total expiries dispatched since construction */
+    std::uint64_t expiryCount() const {
+        return expiries_;
+    }
+
+    /**
+     * @brief Lateness statistics of one entry
+     * @param id Entry handle returned by schedulePeriodic/scheduleOnce
+     * @param nanosecondsPerUnit Scale of the reported unit, e.g. 1e3 for us
+     */
+    ::utils::TimingStats latenessStats(TimerId id,
+                                       double nanosecondsPerUnit) const;
+
+    /** @brief Lateness histogram of one entry, in nanoseconds */
+    const LatencyHistogram& latenessHistogram(TimerId id) const;
+
+    /** @brief Lateness of every expiry of every entry, in nanoseconds */
+    const LatencyHistogram& aggregateLateness() const {
+        return aggregate_;
+    }
+
+    /**
+     * @brief Delay from every expiry's deadline to the tick it was rounded
+     * up to, in nanoseconds; lateness comes on top of it
+     */
+    const LatencyHistogram& quantization() const {
+        return quantization_;
+    }
+
+    AdaptiveSpinScheduler::Report schedulerReport() const {
+        return scheduler_.report();
+    }
+
+private:
+    static constexpr int kLevels          = 4;
+    static constexpr int kSlotBits        = 8;
+    static constexpr std::uint32_t kSlots = 1u << kSlotBits;
+    static constexpr std::uint32_t kNone  = ~std::uint32_t{0};
+
+    struct Entry {
+        explicit Entry(int histogramBits);
+
+        std::uint64_t expiresTick = 0;
+        std::int64_t deadlineNs   = 0;
+        std::int64_t periodNs     = 0;  // 0 for one-shot entries
+        std::uint32_t prev        = kNone;
+        std::uint32_t next        = kNone;
+        std::uint32_t list        = kNone;  // level * kSlots + slot
+        std::uint32_t generation  = 0;
+        bool active               = false;
+        Callback callback;
+        LatencyHistogram lateness;
+    };
+
+    TimerId schedule(Clock::time_point deadline,
+                     std::chrono::nanoseconds period, Callback callback);
+    std::uint64_t tickFor(std::int64_t deadlineNs) const;
+    void place(std::uint32_t index);
+    void unlink(std::uint32_t index);
+    void release(std::uint32_t index);
+    void cascade(int level, std::uint32_t slot);
+    void processTick(std::uint64_t tick);
+    void fire(std::uint32_t index);
+    std::uint64_t nextWakeTick() const;
+    std::int64_t tickTimeNs(std::uint64_t tick) const;
+    Entry* lookup(TimerId id);
+    const Entry* lookup(TimerId id) const;
+
+    std::int64_t resolutionNs_;
+    std::int64_t originNs_;
+    std::uint64_t currentTick_ = 0;
+
+    std::vector<Entry> entries_;
+    std::vector<std::uint32_t> freeList_;
+    std::array<std::uint32_t, kLevels * kSlots> heads_;
+
+    std::size_t activeCount_ = 0;
+    std::uint64_t expiries_  = 0;
+    std::uint32_t firing_    = kNone;  // Entry whose callback is running
+    bool releaseDeferred_    = false;
+    LatencyHistogram aggregate_;
+    LatencyHistogram quantization_;
+    AdaptiveSpinScheduler scheduler_;
+    SpinRelax spin_;
+    std::atomic<bool> stopRequested_{false};
+};
+
+/**
+ * @brief Host count no-op periodic probes with mixed periods (1x to 4x
+ * intervalSec) on one wheel for intervals base intervals, then log the
+ * aggregate lateness and tick quantization, the worst probes and the
+ * dispatcher's sleep/spin split
+ */
+void runWheelProbes(double intervalSec, std::size_t count,
+                    std::size_t intervals, SpinPolicy spinPolicy);
+
+}  // namespace ts
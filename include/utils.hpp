@@ -13,12 +13,21 @@ namespace utils {
  * @brief Structure to hold timing statistics
  */
 struct TimingStats {
+    std::size_t count;
     double average;
     double p50;
     double p75;
     double p90;
     double p95;
     double p99;
+    double p999;
+    double p9999;
+    double stddev;
+    double min;
+    double max;
+    double meanAbsDeviation;  ///< From the target interval; NaN without one
+    double maxJitter;  ///< Largest change between consecutive values; NaN
+                       ///< without the raw samples
 };
 
 /**
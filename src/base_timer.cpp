@@ -1,120 +1,520 @@
 #include "base_timer.hpp"
 
 #include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
-#include <numeric>
+#include <iterator>
+#include <sstream>
 #include <stdexcept>
+#include <string_view>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#include <io.h>
+#include <mmsystem.h>
+#else
+#include <unistd.h>
+#endif
 
 #include "logger.hpp"
+#include "sample_stats.hpp"
 
 namespace ts {
 
-BaseTimer::BaseTimer(double intervalSec, const std::string& unit)
+namespace {
+
+/**
+ * @brief Tick lines formatted with std::to_chars into a fixed buffer and
+ * written to stdout with one write per flush, bypassing std::cout
+ */
+class LineBatch {
+public:
+    /** @brief Room kept free for one more line */
+    static constexpr std::size_t kMaxLineLength = 128;
+
+    LineBatch(char* data, std::size_t capacity)
+        : data_(data), capacity_(capacity) {}
+
+    ~LineBatch() {
+        flush();
+    }
+
+    LineBatch(const LineBatch&)            = delete;
+    LineBatch& operator=(const LineBatch&) = delete;
+
+    void append(std::string_view text) {
+        std::memcpy(data_ + size_, text.data(), text.size());
+        size_ += text.size();
+    }
+
+    void append(std::int64_t value) {
+        size_ = static_cast<std::size_t>(
+            std::to_chars(data_ + size_, data_ + capacity_, value).ptr -
+            data_);
+    }
+
+    /** @brief Same digits as std::cout's default (%g) formatting */
+    void append(double value) {
+        size_ = static_cast<std::size_t>(
+            std::to_chars(data_ + size_, data_ + capacity_, value,
+                          std::chars_format::general, 6)
+                .ptr -
+            data_);
+    }
+
+    bool nearlyFull() const {
+        return capacity_ - size_ < kMaxLineLength;
+    }
+
+    /** @brief Write everything buffered; a failed write drops the batch */
+    void flush() {
+        const char* next = data_;
+        std::size_t left = size_;
+        while (left > 0) {
+#ifdef _WIN32
+            int written = _write(1, next, static_cast<unsigned int>(left));
+#else
+            ssize_t written = ::write(STDOUT_FILENO, next, left);
+#endif
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            next += written;
+            left -= static_cast<std::size_t>(written);
+        }
+        size_ = 0;
+    }
+
+private:
+    char* data_;
+    std::size_t capacity_;
+    std::size_t size_ = 0;
+};
+
+}  // anonymous namespace
+
+#ifdef _WIN32
+PlatformTimingGuard::PlatformTimingGuard(bool highestPriority) {
+    timeBeginPeriod(1);
+    BOOL result = SetThreadPriority(
+        GetCurrentThread(), highestPriority ? THREAD_PRIORITY_HIGHEST
+                                            : THREAD_PRIORITY_ABOVE_NORMAL);
+    if (!result) {
+        std::cerr << "Warning: Failed to set thread priority. "
+                  << "Timing precision may be affected.\n";
+    }
+}
+
+PlatformTimingGuard::~PlatformTimingGuard() {
+    BOOL result =
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
+    if (!result) {
+        std::cerr << "Warning: Failed to restore thread priority.\n";
+    }
+    timeEndPeriod(1);
+}
+#else
+PlatformTimingGuard::PlatformTimingGuard(bool) {}
+
+PlatformTimingGuard::~PlatformTimingGuard() = default;
+#endif
+
+BaseTimer::BaseTimer(double intervalSec, const char* unit,
+                     std::int64_t nanosecondsPerUnit)
     : interval_(
           std::chrono::nanoseconds(static_cast<long long>(intervalSec * 1e9))),
       intervals_(),
-      unit_(unit) {
+      unit_(unit),
+      nanosecondsPerUnit_(static_cast<double>(nanosecondsPerUnit)),
+      histogram_(),
+      latenessHistogram_(),
+      outputQueue_(std::in_place, kOutputQueueCapacity),
+      outputBuffer_(kOutputBufferBytes) {
     intervals_.reserve(100);
 }
 
 BaseTimer::~BaseTimer() {
     // Ensure output thread is stopped if still running
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        stopOutputThread_ = true;
+    stopOutputThreadAndJoin();
+}
+
+void BaseTimer::beginRecording(std::size_t iterations,
+                               const char* clockName) {
+    histogram_.reset();
+    latenessHistogram_.reset();
+    intervals_.clear();
+    capturedSamples_ = 0;
+
+    if (!capturePath_.empty()) {
+        // The capture file holds every sample, so none are kept in memory
+        rawCaptureSlots_ = 0;
+
+        CaptureHeader header{};
+        std::strncpy(header.clockSource, clockName,
+                     sizeof(header.clockSource) - 1);
+        std::strncpy(header.unit, unit_, sizeof(header.unit) - 1);
+        header.nanosecondsPerUnit = nanosecondsPerUnit_;
+        header.intervalNs         = interval_.count();
+        capture_.open(capturePath_, header, iterations);
+    } else {
+        rawCaptureSlots_ = std::min(iterations, rawCaptureLimit_);
     }
-    queueCV_.notify_all();
-    if (outputThread_.joinable()) {
-        outputThread_.join();
+#ifdef TS_ENABLE_TRACE
+    std::size_t traceTicks =
+        iterations == 0 ? TickTrace::kDefaultLimit
+                        : std::min(iterations, TickTrace::kDefaultLimit);
+#else
+    std::size_t traceTicks = 0;
+#endif
+    if (arenaOptions_.enabled || arena_) {
+        placeRunBuffers(traceTicks);
+    } else {
+#ifdef TS_ENABLE_TRACE
+        trace_.reset(traceTicks);
+#endif
+    }
+    intervals_.reserve(rawCaptureSlots_);
+
+    if (live_) {
+        live_->begin(clockName, unit_, interval_.count());
+    }
+
+    overrunStats_    = OverrunStats{};
+    missedThroughNs_ = INT64_MIN;
+    if (catchUpHistogram_) {
+        catchUpHistogram_->reset();
+    }
+    faultsAtStart_ = PageFaults{};
+    runFaults_     = PageFaults{};
+
+#ifdef TS_ENABLE_TRACE
+    clockName_ = clockName;
+#endif
+}
+
+void BaseTimer::placeRunBuffers([[maybe_unused]] std::size_t traceTicks) {
+    if (!arenaOptions_.enabled) {
+        // Back to the heap; the last run's samples go with the arena
+        outputQueue_.emplace(kOutputQueueCapacity);
+        outputBuffer_ = ArenaVector<char>(kOutputBufferBytes);
+        intervals_    = ArenaVector<std::int64_t>();
+#ifdef TS_ENABLE_TRACE
+        trace_.reset(traceTicks);
+#endif
+        arena_.reset();
+        return;
+    }
+
+    // The queue capacity is a power of two, so the ring does not round it
+    std::size_t bytes =
+        RunArena::footprint(kOutputQueueCapacity * sizeof(OutputData)) +
+        RunArena::footprint(kOutputBufferBytes) +
+        RunArena::footprint(rawCaptureSlots_ * sizeof(std::int64_t));
+#ifdef TS_ENABLE_TRACE
+    bytes += RunArena::footprint(TickTrace::blockBytes(traceTicks));
+#endif
+
+    // Faulting in a new block happens here, before the timing loop; the
+    // old one is only unmapped once nothing points into it
+    std::unique_ptr<RunArena> previous;
+    if (!arena_ || rebuildArena_ || arena_->capacity() < bytes) {
+        previous      = std::move(arena_);
+        arena_        = std::make_unique<RunArena>(bytes,
+                                                   arenaOptions_.hugePages);
+        rebuildArena_ = false;
+    } else {
+        arena_->reset();
     }
+    ArenaAllocator<char> alloc(arena_.get());
+    outputQueue_.emplace(kOutputQueueCapacity,
+                         ArenaAllocator<OutputData>(alloc));
+    outputBuffer_ = ArenaVector<char>(kOutputBufferBytes, alloc);
+    intervals_    = ArenaVector<std::int64_t>(alloc);
+#ifdef TS_ENABLE_TRACE
+    trace_.reset(traceTicks,
+                 arena_->allocate(TickTrace::blockBytes(traceTicks)));
+#endif
+}
+
+void BaseTimer::endRecording() {
+    PageFaults now = threadPageFaults();
+    if (now.available && faultsAtStart_.available) {
+        runFaults_.available = true;
+        runFaults_.minor     = now.minor - faultsAtStart_.minor;
+        runFaults_.major     = now.major - faultsAtStart_.major;
+    }
+    if (capture_.isOpen()) {
+        capturedSamples_ = capture_.sampleCount();
+        capture_.close();
+    }
+    if (live_) {
+        live_->end();
+    }
+    // Cleared here rather than in beginRecording() so that a stop requested
+    // just before the run is not lost
+    stopRequested_.store(false, std::memory_order_relaxed);
+}
+
+void BaseTimer::setSoakWindows(const std::vector<SoakWindow>& windows) {
+    if (windows.empty()) {
+        soak_.reset();
+    } else {
+        soak_ = std::make_unique<SoakAggregator>(windows, unit_,
+                                                 nanosecondsPerUnit_,
+                                                 droppedOutputs_);
+    }
+    outputEnabled_ = tickOutput_ || soak_;
+}
+
+void BaseTimer::setLiveStats(const std::string& name,
+                             std::chrono::nanoseconds window) {
+    live_.reset();
+    if (!name.empty()) {
+        live_ = std::make_unique<LiveStatsPublisher>(name, window);
+    }
+}
+
+void BaseTimer::setRunArena(const RunArenaOptions& options) {
+    if (options.hugePages != arenaOptions_.hugePages) {
+        rebuildArena_ = true;
+    }
+    arenaOptions_ = options;
+}
+
+void BaseTimer::setExcludeCatchUp(bool exclude) {
+    if (!exclude) {
+        catchUpHistogram_.reset();
+    } else if (!catchUpHistogram_) {
+        catchUpHistogram_ = std::make_unique<LatencyHistogram>();
+    }
+}
+
+std::int64_t BaseTimer::accountOverrun(std::int64_t deadlineNs,
+                                       std::int64_t latenessNs) {
+    const std::int64_t intervalNs = interval_.count();
+    std::int64_t missed           = latenessNs / intervalNs;
+
+    // The catch-up ticks fired for these deadlines are late by a period or
+    // more as well, so each deadline is only counted by the first of them
+    std::int64_t lastMissedNs = deadlineNs + missed * intervalNs;
+    std::int64_t newlyMissed =
+        (lastMissedNs - std::max(deadlineNs, missedThroughNs_)) / intervalNs;
+    if (newlyMissed > 0) {
+        ++overrunStats_.overruns;
+        overrunStats_.missedDeadlines +=
+            static_cast<std::uint64_t>(newlyMissed);
+        missedThroughNs_ = lastMissedNs;
+    }
+    overrunStats_.longestOverrunNs =
+        std::max(overrunStats_.longestOverrunNs, latenessNs);
+
+    switch (overrunPolicy_) {
+    case OverrunPolicy::CatchUp:
+        break;
+    case OverrunPolicy::Skip:
+        return missed * intervalNs;
+    case OverrunPolicy::Reanchor:
+        return latenessNs;
+    }
+    return 0;
 }
 
 void BaseTimer::startOutputThread() {
-    stopOutputThread_ = false;
-    outputThread_     = std::thread(&BaseTimer::outputWorker, this);
+    if (!outputEnabled_) {
+        return;
+    }
+    stopOutputThread_.store(false, std::memory_order_relaxed);
+    droppedOutputs_.store(0, std::memory_order_relaxed);
+    // Tick lines bypass std::cout, so anything it still buffers goes first
+    std::cout.flush();
+    outputThread_ = std::thread(&BaseTimer::outputWorker, this);
 }
 
 void BaseTimer::stopOutputThreadAndJoin() {
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        stopOutputThread_ = true;
-    }
-    queueCV_.notify_all();
+    stopOutputThread_.store(true, std::memory_order_release);
     if (outputThread_.joinable()) {
         outputThread_.join();
+        if (realtime_.enabled && realtime_.outputCpu >= 0) {
+            if (outputPinError_.empty()) {
+                realtimeReport_.applied.push_back(
+                    "output thread pinned to CPU " +
+                    std::to_string(realtime_.outputCpu));
+            } else {
+                realtimeReport_.skipped.push_back(
+                    "output thread CPU pinning: " + outputPinError_);
+            }
+        }
     }
 }
 
 void BaseTimer::enqueueOutput(const OutputData& data) {
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        outputQueue_.push(data);
+    if (!outputEnabled_) {
+        return;
+    }
+    // Never block the timing thread: if the printer has fallen behind, the
+    // record is dropped and counted instead.
+    if (!outputQueue_->tryPush(data)) {
+        droppedOutputs_.fetch_add(1, std::memory_order_relaxed);
     }
-    queueCV_.notify_one();
 }
 
 void BaseTimer::outputWorker() {
-    while (true) {
-        OutputData data;
-        bool hasData = false;
-        {
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            queueCV_.wait(lock, [this] {
-                return !outputQueue_.empty() || stopOutputThread_;
-            });
-
-            if (stopOutputThread_ && outputQueue_.empty()) {
-                break;
-            }
+    // The consumer polls instead of waiting on a condition variable so the
+    // producer never pays for a futex wake. The poll period backs off while
+    // the queue stays empty and resets as soon as a batch arrives.
+    constexpr auto kMinBackoff = std::chrono::microseconds(50);
+    constexpr auto kMaxBackoff = std::chrono::milliseconds(2);
+    auto backoff               = kMinBackoff;
 
-            if (!outputQueue_.empty()) {
-                data    = outputQueue_.front();
-                hasData = true;
-                outputQueue_.pop();
-            }
-        }
+    outputPinError_.clear();
+    if (realtime_.enabled && realtime_.outputCpu >= 0 &&
+        !pinCurrentThread(realtime_.outputCpu, outputPinError_)) {
+        std::cerr << "Warning: real-time setting not applied, output thread "
+                  << "CPU pinning: " << outputPinError_ << "\n";
+    }
+
+    // Ticks arrive as integer nanoseconds; convert and format here, off the
+    // timing thread, with every string piece built once per run
+    auto nsPerUnit = static_cast<std::int64_t>(nanosecondsPerUnit_);
+    const std::string startPrefix =
+        std::string("Start Timestamp (") + unit_ + "): ";
+    const std::string tickPrefix = std::string("Timestamp (") + unit_ + "): ";
+    const std::string intervalSuffix = std::string(" ") + unit_ + ")\n";
+    LineBatch batch(outputBuffer_.data(), kOutputBufferBytes);
 
-        if (hasData) {
+    auto print = [&](const OutputData& data) {
+        if (soak_) {
             if (data.type == OutputData::Type::Interval) {
-                std::cout << "Timestamp (" << unit_ << "): " << data.timestamp
-                          << "\t"
-                          << "(real interval: " << data.realInterval << " "
-                          << unit_ << ")\n";
+                soak_->add(data.timestampNs, data.intervalNs);
             } else {
-                std::cout << "Start Timestamp (" << unit_
-                          << "): " << data.timestamp << "\n";
+                soak_->start(data.timestampNs);
             }
         }
+        if (!tickOutput_) {
+            return;
+        }
+        if (batch.nearlyFull()) {
+            batch.flush();
+        }
+        if (data.type == OutputData::Type::Interval) {
+            batch.append(tickPrefix);
+            batch.append(data.timestampNs / nsPerUnit);
+            batch.append(std::string_view("\t(real interval: "));
+            batch.append(static_cast<double>(data.intervalNs) /
+                         nanosecondsPerUnit_);
+            batch.append(intervalSuffix);
+        } else {
+            batch.append(startPrefix);
+            batch.append(data.timestampNs / nsPerUnit);
+            batch.append(std::string_view("\n"));
+        }
+    };
+
+    // Everything available is drained per pass and written in one go
+    while (true) {
+        if (outputQueue_->consume(print) > 0) {
+            batch.flush();
+            backoff = kMinBackoff;
+            continue;
+        }
+
+        // Check the flag before the final drain so that records pushed just
+        // before the stop request are still printed.
+        if (stopOutputThread_.load(std::memory_order_acquire)) {
+            outputQueue_->consume(print);
+            batch.flush();
+            break;
+        }
+
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min<std::chrono::microseconds>(backoff * 2, kMaxBackoff);
+    }
+    if (soak_) {
+        soak_->finish();
     }
+    std::cout.flush();
 }
 
 ::utils::TimingStats BaseTimer::calculateStatistics() const {
-    if (intervals_.empty()) {
+    if (histogram_.count() == 0) {
         throw std::runtime_error("No intervals collected");
     }
 
-    ::utils::TimingStats stats{};
-
-    double sum    = std::accumulate(intervals_.begin(), intervals_.end(), 0.0);
-    stats.average = sum / intervals_.size();
-
-    std::vector<double> sorted = intervals_;
-    std::sort(sorted.begin(), sorted.end());
+    ::utils::TimingStats stats =
+        makeTimingStats(histogram_, nanosecondsPerUnit_, interval_.count());
+    if (intervals_.size() != histogram_.count()) {
+        return stats;
+    }
 
-    stats.p50 = ::utils::calculatePercentile(sorted, 0.50);
-    stats.p75 = ::utils::calculatePercentile(sorted, 0.75);
-    stats.p90 = ::utils::calculatePercentile(sorted, 0.90);
-    stats.p95 = ::utils::calculatePercentile(sorted, 0.95);
-    stats.p99 = ::utils::calculatePercentile(sorted, 0.99);
+    SampleSummary summary = summarizeSamples(
+        intervals_.data(), intervals_.size(), interval_.count());
+    stats.average = summary.mean / nanosecondsPerUnit_;
+    stats.stddev  = summary.stddev / nanosecondsPerUnit_;
+    stats.min     = static_cast<double>(summary.min) / nanosecondsPerUnit_;
+    stats.max     = static_cast<double>(summary.max) / nanosecondsPerUnit_;
+    stats.meanAbsDeviation = summary.meanAbsDeviation / nanosecondsPerUnit_;
+    stats.maxJitter =
+        static_cast<double>(summary.maxJitter) / nanosecondsPerUnit_;
 
+    static constexpr double kFractions[] = {0.50, 0.75, 0.90,  0.95,
+                                            0.99, 0.999, 0.9999};
+    std::int64_t values[std::size(kFractions)];
+    selector_.select(intervals_.data(), intervals_.size(), kFractions,
+                     std::size(kFractions), values);
+    double* targets[] = {&stats.p50, &stats.p75,  &stats.p90,  &stats.p95,
+                         &stats.p99, &stats.p999, &stats.p9999};
+    for (std::size_t i = 0; i < std::size(kFractions); ++i) {
+        *targets[i] = static_cast<double>(values[i]) / nanosecondsPerUnit_;
+    }
     return stats;
 }
 
-void BaseTimer::printStatistics(const ::utils::TimingStats& stats) const {
+double BaseTimer::percentile(double p) const {
+    std::int64_t value = 0;
+    if (histogram_.count() != 0 && intervals_.size() == histogram_.count()) {
+        selector_.select(intervals_.data(), intervals_.size(), &p, 1, &value);
+    } else {
+        value = static_cast<std::int64_t>(histogram_.valueAtPercentile(p));
+    }
+    return static_cast<double>(value) / nanosecondsPerUnit_;
+}
+
+void BaseTimer::printStatisticsBlock(
+    const ::utils::TimingStats& stats) const {
+    // Jitter needs consecutive raw samples, which a run past the raw
+    // capture limit no longer has
+    auto valueOrMissing = [](double value) {
+        std::ostringstream text;
+        text << std::fixed << std::setprecision(2);
+        if (std::isnan(value)) {
+            text << "n/a (raw samples not kept in memory)";
+        } else {
+            text << value;
+        }
+        return text.str();
+    };
+
     logger << std::fixed << std::setprecision(2);
     logger << "\n========== Timing Statistics ==========\n"
            << "Intervals average (" << unit_ << "): " << stats.average << "\n"
+           << "Intervals stddev (" << unit_ << "): " << stats.stddev << "\n"
+           << "Intervals min (" << unit_ << "): " << stats.min << "\n"
+           << "Intervals max (" << unit_ << "): " << stats.max << "\n"
            << "Intervals 50th Percentile (" << unit_ << "): " << stats.p50
            << "\n"
            << "Intervals 75th Percentile (" << unit_ << "): " << stats.p75
@@ -125,12 +525,103 @@ void BaseTimer::printStatistics(const ::utils::TimingStats& stats) const {
            << "\n"
            << "Intervals 99th Percentile (" << unit_ << "): " << stats.p99
            << "\n"
+           << "Intervals 99.9th Percentile (" << unit_ << "): " << stats.p999
+           << "\n"
+           << "Intervals 99.99th Percentile (" << unit_
+           << "): " << stats.p9999 << "\n"
+           << "Mean absolute deviation from interval (" << unit_
+           << "): " << valueOrMissing(stats.meanAbsDeviation) << "\n"
+           << "Max consecutive jitter (" << unit_
+           << "): " << valueOrMissing(stats.maxJitter) << "\n"
            << "========================================\n";
+}
+
+void BaseTimer::printRunReport(const ::utils::TimingStats& stats) const {
+    if (realtime_.enabled) {
+        logger << "Real-time settings applied:";
+        for (const std::string& item : realtimeReport_.applied) {
+            logger << "\n  " << item;
+        }
+        if (realtimeReport_.applied.empty()) {
+            logger << " none";
+        }
+        logger << "\n";
+        for (const std::string& item : realtimeReport_.skipped) {
+            logger << "Real-time setting skipped: " << item << "\n";
+        }
+    }
+
+    if (arena_) {
+        logger << "Run arena: "
+               << static_cast<double>(arena_->capacity()) / (1024.0 * 1024.0)
+               << " MiB prefaulted" << (arena_->locked() ? " and locked" : "")
+               << ", huge pages: " << hugePagesName(arena_->hugePages())
+               << "\n";
+        for (const std::string& warning : arena_->warnings()) {
+            logger << "Run arena setting skipped: " << warning << "\n";
+        }
+        if (!arena_->lockError().empty()) {
+            logger << "Run arena setting skipped: " << arena_->lockError()
+                   << "\n";
+        }
+    }
+    if (runFaults_.available) {
+        logger << "Page faults in the timing loop: " << runFaults_.minor
+               << " minor, " << runFaults_.major << " major\n";
+    }
+
+    if (overrunStats_.overruns > 0) {
+        logger << "Deadline overruns (" << overrunPolicyName(overrunPolicy_)
+               << "): " << overrunStats_.overruns << " ("
+               << overrunStats_.missedDeadlines
+               << " deadlines missed, longest "
+               << static_cast<double>(overrunStats_.longestOverrunNs) /
+                      nanosecondsPerUnit_
+               << " " << unit_ << " late)\n";
+    }
+    if (overrunStats_.catchUpTicks > 0) {
+        logger << "Catch-up ticks: " << overrunStats_.catchUpTicks;
+        if (catchUpHistogram_) {
+            logger << " (excluded from the statistics; intervals average "
+                   << catchUpHistogram_->mean() / nanosecondsPerUnit_
+                   << " " << unit_ << ", max "
+                   << static_cast<double>(catchUpHistogram_->max()) /
+                          nanosecondsPerUnit_
+                   << " " << unit_ << ")\n";
+        } else {
+            logger << " (included in the statistics)\n";
+        }
+    }
+
+    std::uint64_t dropped = getDroppedOutputs();
+    if (dropped > 0) {
+        logger << "Output records dropped (printer fell behind): " << dropped
+               << " (queue capacity " << outputQueue_->capacity() << ")\n";
+    }
+
+    if (capturedSamples_ > 0) {
+        logger << "Raw interval data: " << capturePath_ << " ("
+               << capturedSamples_
+               << " samples, binary; convert with timer-convert)\n";
+        return;
+    }
+    if (intervals_.empty()) {
+        // Raw capture disabled, e.g. in an unbounded soak run
+        return;
+    }
 
     logger.fileOnly() << "\n========== Raw Interval Data (" << unit_
                       << ") ==========\n";
     for (std::size_t i = 0; i < intervals_.size(); ++i) {
-        logger.fileOnly() << i + 1 << ": " << intervals_[i] << "\n";
+        logger.fileOnly() << i + 1 << ": "
+                          << static_cast<double>(intervals_[i]) /
+                                 nanosecondsPerUnit_
+                          << "\n";
+    }
+    if (intervals_.size() < stats.count) {
+        logger.fileOnly() << "(raw capture limited to the first "
+                          << intervals_.size() << " of " << stats.count
+                          << " intervals)\n";
     }
 }
 
@@ -0,0 +1,320 @@
+#include "capture.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+// Minimum pre-size, and the staging buffer size of the stdio fallback
+constexpr std::size_t kMinCapacity = 65536;
+
+// Extent mapped each time a run outgrows the file, 8M samples
+constexpr std::size_t kChunkBytes = 64 * 1024 * 1024;
+
+std::runtime_error captureError(const std::string& what,
+                                const std::string& path) {
+    return std::runtime_error(what + ": " + path + " (" +
+                              std::strerror(errno) + ")");
+}
+
+#ifndef _WIN32
+std::size_t pageBytes() {
+    long size = ::sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<std::size_t>(size) : 4096;
+}
+#endif
+
+}  // anonymous namespace
+
+CaptureWriter::~CaptureWriter() {
+    if (open_) {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; the file is left as written
+        }
+    }
+}
+
+void CaptureWriter::open(const std::string& path, const CaptureHeader& header,
+                         std::size_t expectedSamples) {
+    if (open_) {
+        close();
+    }
+
+    CaptureHeader h = header;
+    std::memcpy(h.magic, CaptureHeader::kMagic, sizeof(h.magic));
+    h.version      = CaptureHeader::kVersion;
+    h.headerSize   = sizeof(CaptureHeader);
+    h.sampleCount  = 0;
+    h.sampleFormat = CaptureHeader::kFormatI64;
+    h.reserved     = 0;
+
+    path_                = path;
+    flushedSamples_      = 0;
+    std::size_t capacity = std::max(expectedSamples, kMinCapacity);
+
+#ifndef _WIN32
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        throw captureError("Failed to create capture file", path);
+    }
+    // Page aligned, so that every later chunk starts on a page and no
+    // sample straddles two chunks
+    std::size_t bytes =
+        sizeof(CaptureHeader) + capacity * sizeof(std::int64_t);
+    bytes = (bytes + pageBytes() - 1) / pageBytes() * pageBytes();
+    Chunk first = mapChunk(0, bytes);
+    chunks_.push_back(first);
+    mappedEnd_ = first.bytes;
+
+    header_  = static_cast<CaptureHeader*>(first.base);
+    *header_ = h;
+    samples_ = reinterpret_cast<std::int64_t*>(header_ + 1);
+    cursor_  = samples_;
+    end_     = static_cast<std::int64_t*>(first.base) +
+               first.bytes / sizeof(std::int64_t);
+
+    if (expectedSamples == 0) {
+        stopExtending_ = false;
+        extendError_   = nullptr;
+        extender_      = std::thread(&CaptureWriter::extendLoop, this);
+    }
+#else
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) {
+        throw captureError("Failed to create capture file", path);
+    }
+    fallbackHeader_ = h;
+    std::fwrite(&fallbackHeader_, sizeof(fallbackHeader_), 1, file_);
+    fallbackBuffer_.assign(kMinCapacity, 0);
+    flushedSamples_ = 0;
+    samples_        = fallbackBuffer_.data();
+    cursor_         = samples_;
+    end_            = samples_ + fallbackBuffer_.size();
+    header_         = &fallbackHeader_;
+#endif
+    open_ = true;
+}
+
+void CaptureWriter::setStartTime(std::int64_t startTimeNs) {
+    if (header_ != nullptr) {
+        header_->startTimeNs = startTimeNs;
+    }
+}
+
+std::uint64_t CaptureWriter::sampleCount() const {
+    return flushedSamples_ + static_cast<std::uint64_t>(cursor_ - samples_);
+}
+
+#ifndef _WIN32
+
+CaptureWriter::Chunk CaptureWriter::mapChunk(std::size_t offset,
+                                             std::size_t bytes) {
+    if (::ftruncate(fd_, static_cast<off_t>(offset + bytes)) != 0) {
+        throw captureError("Failed to size capture file", path_);
+    }
+    void* base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                        fd_, static_cast<off_t>(offset));
+    if (base == MAP_FAILED) {
+        throw captureError("Failed to map capture file", path_);
+    }
+    // A store, not a load: a load maps the page read-only and the first
+    // sample would still take a write fault
+    const std::size_t step = pageBytes();
+    for (std::size_t at = 0; at < bytes; at += step) {
+        static_cast<volatile unsigned char*>(base)[at] = 0;
+    }
+    return {base, bytes};
+}
+
+void CaptureWriter::extendLoop() {
+    std::unique_lock<std::mutex> lock(extendMutex_);
+    while (true) {
+        extendWake_.wait(lock, [this] {
+            return stopExtending_ || spare_.base == nullptr;
+        });
+        if (stopExtending_) {
+            return;
+        }
+        std::size_t offset = mappedEnd_;
+        lock.unlock();
+        Chunk chunk;
+        std::exception_ptr error;
+        try {
+            chunk = mapChunk(offset, kChunkBytes);
+            // The chunk table grows here, never on the timing thread, and
+            // outside the lock the timing thread may be waiting for
+            chunks_.push_back(chunk);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        lock.lock();
+        if (error) {
+            extendError_ = error;
+            extendWake_.notify_all();
+            return;
+        }
+        spare_     = chunk;
+        mappedEnd_ = offset + chunk.bytes;
+        extendWake_.notify_all();
+    }
+}
+
+void CaptureWriter::stopExtender() {
+    if (!extender_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(extendMutex_);
+        stopExtending_ = true;
+    }
+    extendWake_.notify_all();
+    extender_.join();
+    // An unused spare is in chunks_ and unmapped with the rest
+    spare_ = Chunk{};
+}
+
+void CaptureWriter::unmap() {
+    for (const Chunk& chunk : chunks_) {
+        ::munmap(chunk.base, chunk.bytes);
+    }
+    chunks_.clear();
+    header_    = nullptr;
+    samples_   = nullptr;
+    cursor_    = nullptr;
+    end_       = nullptr;
+    mappedEnd_ = 0;
+}
+
+void CaptureWriter::grow() {
+    // The current chunk is full. Filled chunks stay mapped: unmapping them
+    // here would flush TLBs on the timing thread's CPU
+    Chunk chunk;
+    if (extender_.joinable()) {
+        std::unique_lock<std::mutex> lock(extendMutex_);
+        // Only waits if the helper fell a whole chunk behind
+        extendWake_.wait(lock, [this] {
+            return spare_.base != nullptr || extendError_ != nullptr;
+        });
+        if (spare_.base == nullptr) {
+            std::rethrow_exception(extendError_);
+        }
+        chunk  = spare_;
+        spare_ = Chunk{};
+        lock.unlock();
+        extendWake_.notify_one();
+    } else {
+        // A bounded run that outgrew its estimate
+        chunk = mapChunk(mappedEnd_, kChunkBytes);
+        mappedEnd_ += chunk.bytes;
+        chunks_.push_back(chunk);
+    }
+
+    flushedSamples_ += static_cast<std::uint64_t>(cursor_ - samples_);
+    samples_ = static_cast<std::int64_t*>(chunk.base);
+    cursor_  = samples_;
+    end_     = samples_ + chunk.bytes / sizeof(std::int64_t);
+}
+
+void CaptureWriter::close() {
+    if (!open_) {
+        return;
+    }
+    std::uint64_t count  = sampleCount();
+    header_->sampleCount = count;
+    stopExtender();
+    unmap();
+    std::size_t bytes = sizeof(CaptureHeader) +
+                        static_cast<std::size_t>(count) * sizeof(std::int64_t);
+    int truncated = ::ftruncate(fd_, static_cast<off_t>(bytes));
+    ::close(fd_);
+    fd_   = -1;
+    open_ = false;
+    if (truncated != 0) {
+        throw captureError("Failed to trim capture file", path_);
+    }
+}
+
+#else
+
+void CaptureWriter::unmap() {}
+
+void CaptureWriter::grow() {
+    std::size_t used = static_cast<std::size_t>(cursor_ - samples_);
+    std::fwrite(samples_, sizeof(std::int64_t), used, file_);
+    flushedSamples_ += used;
+    cursor_ = samples_;
+}
+
+void CaptureWriter::close() {
+    if (!open_) {
+        return;
+    }
+    grow();
+    fallbackHeader_.sampleCount = flushedSamples_;
+    std::fseek(file_, 0, SEEK_SET);
+    std::fwrite(&fallbackHeader_, sizeof(fallbackHeader_), 1, file_);
+    std::fclose(file_);
+    file_   = nullptr;
+    header_ = nullptr;
+    open_   = false;
+}
+
+#endif
+
+Capture readCapture(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw captureError("Failed to open capture file", path);
+    }
+
+    Capture capture{};
+    in.read(reinterpret_cast<char*>(&capture.header), sizeof(CaptureHeader));
+    const CaptureHeader& h = capture.header;
+    if (!in || std::memcmp(h.magic, CaptureHeader::kMagic, 8) != 0) {
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+    if (h.version != CaptureHeader::kVersion ||
+        h.headerSize != sizeof(CaptureHeader) ||
+        h.sampleFormat != CaptureHeader::kFormatI64) {
+        throw std::runtime_error("Unsupported capture format: " + path);
+    }
+
+    capture.samples.resize(static_cast<std::size_t>(h.sampleCount));
+    in.read(reinterpret_cast<char*>(capture.samples.data()),
+            static_cast<std::streamsize>(capture.samples.size() *
+                                         sizeof(std::int64_t)));
+    if (!in) {
+        throw std::runtime_error("Truncated capture file: " + path);
+    }
+    return capture;
+}
+
+void writeCaptureAsText(const Capture& capture, std::ostream& out) {
+    const CaptureHeader& h = capture.header;
+    std::string unit(h.unit, strnlen(h.unit, sizeof(h.unit)));
+
+    out << std::fixed << std::setprecision(2);
+    out << "\n========== Raw Interval Data (" << unit << ") ==========\n";
+    for (std::size_t i = 0; i < capture.samples.size(); ++i) {
+        out << i + 1 << ": "
+            << static_cast<double>(capture.samples[i]) / h.nanosecondsPerUnit
+            << "\n";
+    }
+}
+
+}  // namespace ts
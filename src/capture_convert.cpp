@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "capture.hpp"
+#include "quantile_select.hpp"
+#include "sample_stats.hpp"
+
+namespace {
+
+void printUsage(const char* programName) {
+    std::cerr << "Usage: " << programName
+              << " <capture file> [output file] [--info] [--stats]\n"
+              << "  Converts a binary interval capture to the text layout of "
+                 "the log's raw interval section\n"
+              << "  --info   Print the capture header to stderr\n"
+              << "  --stats  Print statistics of the samples instead of "
+                 "converting\n";
+}
+
+void printStatistics(const ts::Capture& capture, std::ostream& out) {
+    static constexpr double kFractions[]   = {0.50, 0.90, 0.99, 0.999,
+                                              0.9999};
+    static constexpr const char* kLabels[] = {"50th", "90th", "99th",
+                                              "99.9th", "99.99th"};
+    const ts::CaptureHeader& h = capture.header;
+    std::string unit(h.unit, strnlen(h.unit, sizeof(h.unit)));
+
+    std::int64_t values[std::size(kFractions)];
+    ts::QuantileSelector selector;
+    selector.select(capture.samples.data(), capture.samples.size(),
+                    kFractions, std::size(kFractions), values);
+
+    ts::SampleSummary summary = ts::summarizeSamples(
+        capture.samples.data(), capture.samples.size(), h.intervalNs);
+    auto scaled = [&](double ns) { return ns / h.nanosecondsPerUnit; };
+
+    out << std::fixed << std::setprecision(2)
+        << "Samples: " << capture.samples.size() << "\n"
+        << "Average (" << unit << "): " << scaled(summary.mean) << "\n"
+        << "Stddev (" << unit << "): " << scaled(summary.stddev) << "\n"
+        << "Min (" << unit << "): "
+        << scaled(static_cast<double>(summary.min)) << "\n"
+        << "Max (" << unit << "): "
+        << scaled(static_cast<double>(summary.max)) << "\n"
+        << "Mean absolute deviation from interval (" << unit
+        << "): " << scaled(summary.meanAbsDeviation) << "\n"
+        << "Max consecutive jitter (" << unit
+        << "): " << scaled(static_cast<double>(summary.maxJitter)) << "\n";
+    for (std::size_t i = 0; i < std::size(kFractions); ++i) {
+        out << kLabels[i] << " Percentile (" << unit << "): "
+            << static_cast<double>(values[i]) / h.nanosecondsPerUnit << "\n";
+    }
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::string input;
+    std::string output;
+    bool info  = false;
+    bool stats = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--info") {
+            info = true;
+        } else if (arg == "--stats") {
+            stats = true;
+        } else if (input.empty()) {
+            input = arg;
+        } else if (output.empty()) {
+            output = arg;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (input.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        ts::Capture capture = ts::readCapture(input);
+
+        if (info) {
+            const ts::CaptureHeader& h = capture.header;
+            std::cerr << "Clock source: "
+                      << std::string(h.clockSource,
+                                     strnlen(h.clockSource,
+                                             sizeof(h.clockSource)))
+                      << "\n"
+                      << "Interval (ns): " << h.intervalNs << "\n"
+                      << "Start timestamp (ns): " << h.startTimeNs << "\n"
+                      << "Samples: " << h.sampleCount << "\n";
+        }
+
+        if (stats) {
+            if (capture.samples.empty()) {
+                throw std::runtime_error("Capture holds no samples");
+            }
+            printStatistics(capture, std::cout);
+            return 0;
+        }
+
+        if (output.empty()) {
+            ts::writeCaptureAsText(capture, std::cout);
+        } else {
+            std::ofstream out(output);
+            if (!out) {
+                throw std::runtime_error("Failed to open output file: " +
+                                         output);
+            }
+            ts::writeCaptureAsText(capture, out);
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
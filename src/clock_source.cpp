@@ -0,0 +1,206 @@
+#include "clock_source.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifdef TS_HAVE_TSC_CLOCK
+#include <cpuid.h>
+#endif
+
+namespace ts {
+
+ClockSourceKind parseClockSourceKind(const std::string& name) {
+    if (name == "auto") return ClockSourceKind::Auto;
+    if (name == "steady") return ClockSourceKind::Steady;
+    if (name == "tsc") return ClockSourceKind::Tsc;
+    throw std::invalid_argument("Invalid clock source: " + name +
+                                " (expected auto, steady or tsc)");
+}
+
+#ifdef TS_HAVE_TSC_CLOCK
+
+namespace {
+
+// Two calibration windows must agree to within this fraction
+constexpr double kMaxCalibrationDrift = 1e-4;
+
+constexpr auto kCalibrationWindow = std::chrono::milliseconds(20);
+
+// Largest rate change a resync applies to remove an offset, 500 ppm
+constexpr double kMaxResyncSlew = 5e-4;
+
+struct ClockPair {
+    std::uint64_t tsc;
+    std::int64_t steadyNs;
+};
+
+std::int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool cpuHasInvariantTsc() {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) ||
+        eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx & (1u << 8)) != 0;
+}
+
+// Read the TSC between two steady_clock reads and keep the tightest bracket,
+// so the pair is accurate to a fraction of one steady_clock call.
+ClockPair samplePair() {
+    ClockPair best{};
+    std::int64_t bestWidth = INT64_MAX;
+    for (int i = 0; i < 32; ++i) {
+        unsigned int aux;
+        std::int64_t before = steadyNowNs();
+        std::uint64_t tsc   = __rdtscp(&aux);
+        std::int64_t after  = steadyNowNs();
+        if (after - before < bestWidth) {
+            bestWidth = after - before;
+            best      = {tsc, before + (after - before) / 2};
+        }
+    }
+    return best;
+}
+
+double ticksPerNs(const ClockPair& a, const ClockPair& b) {
+    return static_cast<double>(b.tsc - a.tsc) /
+           static_cast<double>(b.steadyNs - a.steadyNs);
+}
+
+TscCalibration calibrate() {
+    TscCalibration cal;
+    if (!cpuHasInvariantTsc()) {
+        cal.reason = "CPU does not report an invariant TSC";
+        return cal;
+    }
+
+    ClockPair p0 = samplePair();
+    std::this_thread::sleep_for(kCalibrationWindow);
+    ClockPair p1 = samplePair();
+    std::this_thread::sleep_for(kCalibrationWindow);
+    ClockPair p2 = samplePair();
+
+    if (p1.tsc <= p0.tsc || p2.tsc <= p1.tsc) {
+        cal.reason = "TSC is not monotonic";
+        return cal;
+    }
+
+    double first  = ticksPerNs(p0, p1);
+    double second = ticksPerNs(p1, p2);
+    if (std::fabs(first - second) / first > kMaxCalibrationDrift) {
+        std::ostringstream oss;
+        oss << "TSC rate unstable between calibration windows (" << first
+            << " vs " << second << " ticks/ns)";
+        cal.reason = oss.str();
+        return cal;
+    }
+
+    cal.usable             = true;
+    cal.ticksPerNanosecond = ticksPerNs(p0, p2);
+    cal.baseTsc            = p2.tsc;
+    cal.baseSteadyNs       = p2.steadyNs;
+    cal.mult               = static_cast<std::uint64_t>(
+        std::llround(4294967296.0 / cal.ticksPerNanosecond));
+    return cal;
+}
+
+}  // anonymous namespace
+
+const TscCalibration& tscCalibration() {
+    static const TscCalibration calibration = calibrate();
+    return calibration;
+}
+
+#else
+
+const TscCalibration& tscCalibration() {
+    static const TscCalibration calibration = [] {
+        TscCalibration cal;
+        cal.reason = "TSC clock source is only supported on x86-64 Linux";
+        return cal;
+    }();
+    return calibration;
+}
+
+#endif
+
+ClockSource::ClockSource(ClockSourceKind kind) {
+    if (kind == ClockSourceKind::Steady) {
+        return;
+    }
+
+    const TscCalibration& cal = tscCalibration();
+    if (!cal.usable) {
+        if (kind == ClockSourceKind::Tsc) {
+            fallbackReason_ = cal.reason;
+        }
+        return;
+    }
+
+    useTsc_             = true;
+    baseTsc_            = cal.baseTsc;
+    baseSteadyNs_       = cal.baseSteadyNs;
+    mult_               = cal.mult;
+    ticksPerNanosecond_ = cal.ticksPerNanosecond;
+    syncTsc_            = cal.baseTsc;
+    syncSteadyNs_       = cal.baseSteadyNs;
+    nextResync_ =
+        time_point(std::chrono::nanoseconds(syncSteadyNs_)) + kResyncPeriod;
+}
+
+#ifdef TS_HAVE_TSC_CLOCK
+
+void ClockSource::resync() {
+    ClockPair pair      = samplePair();
+    std::int64_t spanNs = pair.steadyNs - syncSteadyNs_;
+    if (pair.tsc > syncTsc_ && spanNs > 0) {
+        double ticksPerNs = static_cast<double>(pair.tsc - syncTsc_) /
+                            static_cast<double>(spanNs);
+        // The new base is where the current mapping puts this TSC reading,
+        // so now() does not step; the offset to steady_clock is slewed out
+        std::int64_t mappedNs = tscToSteadyNs(pair.tsc);
+        double offsetNs       = static_cast<double>(pair.steadyNs - mappedNs);
+        double periodNs =
+            std::chrono::duration<double, std::nano>(kResyncPeriod).count();
+        double slew = std::clamp(offsetNs / periodNs, -kMaxResyncSlew,
+                                 kMaxResyncSlew);
+
+        baseTsc_            = pair.tsc;
+        baseSteadyNs_       = mappedNs;
+        mult_               = static_cast<std::uint64_t>(
+            std::llround(4294967296.0 * (1.0 + slew) / ticksPerNs));
+        ticksPerNanosecond_ = ticksPerNs;
+    }
+    syncTsc_      = pair.tsc;
+    syncSteadyNs_ = pair.steadyNs;
+    nextResync_ =
+        time_point(std::chrono::nanoseconds(syncSteadyNs_)) + kResyncPeriod;
+}
+
+#endif
+
+std::string ClockSource::describe() const {
+    std::ostringstream oss;
+    if (useTsc_) {
+        oss << "tsc (" << std::fixed << std::setprecision(3)
+            << ticksPerNanosecond_ << " GHz)";
+    } else {
+        oss << "steady_clock";
+        if (!fallbackReason_.empty()) {
+            oss << " (TSC unavailable: " << fallbackReason_ << ")";
+        }
+    }
+    return oss.str();
+}
+
+}  // namespace ts
@@ -0,0 +1,228 @@
+#include "coro_executor.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+
+#include "logger.hpp"
+#include "realtime.hpp"
+
+namespace ts {
+
+namespace {
+
+std::int64_t toNs(std::chrono::steady_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               tp.time_since_epoch())
+        .count();
+}
+
+std::chrono::steady_clock::time_point fromNs(std::int64_t ns) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::nanoseconds(ns)));
+}
+
+}  // anonymous namespace
+
+Ticker::Ticker(CoroExecutor& executor, std::chrono::nanoseconds period,
+               int histogramBits)
+    : executor_(executor),
+      period_(period),
+      lateness_(LatencyHistogram::kDefaultHighestTrackable, histogramBits) {
+    if (period_.count() <= 0) {
+        throw std::invalid_argument("Ticker period must be positive");
+    }
+}
+
+void Ticker::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+    ticker_.executor_.schedule(ticker_, handle);
+}
+
+TickInfo Ticker::Awaiter::await_resume() const noexcept {
+    return ticker_.last_;
+}
+
+CoroExecutor::CoroExecutor(std::chrono::nanoseconds shortestPeriod,
+                           std::size_t expectedTasks)
+    : wait_(shortestPeriod) {
+    heap_.reserve(expectedTasks);
+    tasks_.reserve(expectedTasks);
+}
+
+CoroExecutor::~CoroExecutor() {
+    for (PeriodicTask::Handle handle : tasks_) {
+        handle.destroy();
+    }
+    for (PeriodicTask::Handle handle : unstarted_) {
+        handle.destroy();
+    }
+}
+
+void CoroExecutor::spawn(PeriodicTask task) {
+    unstarted_.push_back(std::exchange(task.handle_, {}));
+}
+
+void CoroExecutor::schedule(Ticker& ticker, std::coroutine_handle<> handle) {
+    if (ticker.deadlineNs_ == 0) {
+        ticker.deadlineNs_ = toNs(clock_.now()) + ticker.period_.count();
+    } else {
+        // Drift-free: derived from the previous deadline, not from when the
+        // coroutine actually ran
+        ticker.deadlineNs_ += ticker.period_.count();
+        ++ticker.index_;
+    }
+    heap_.push_back({ticker.deadlineNs_, sequence_++, handle, &ticker});
+    std::push_heap(heap_.begin(), heap_.end(), Later{});
+}
+
+void CoroExecutor::resume(std::coroutine_handle<> handle) {
+    handle.resume();
+    ++resumptions_;
+    if (handle.done()) {
+        reap(handle);
+    }
+}
+
+void CoroExecutor::reap(std::coroutine_handle<> handle) {
+    for (std::size_t i = 0; i < tasks_.size(); ++i) {
+        if (tasks_[i].address() != handle.address()) {
+            continue;
+        }
+        if (tasks_[i].promise().exception && !error_) {
+            error_ = tasks_[i].promise().exception;
+        }
+        tasks_[i].destroy();
+        tasks_[i] = tasks_.back();
+        tasks_.pop_back();
+        return;
+    }
+}
+
+void CoroExecutor::run(std::chrono::steady_clock::time_point until) {
+    stopRequested_.store(false, std::memory_order_relaxed);
+    wait_.begin(clock_);
+
+    // Every new coroutine runs up to its first co_await
+    std::vector<PeriodicTask::Handle> starting;
+    starting.swap(unstarted_);
+    for (PeriodicTask::Handle handle : starting) {
+        tasks_.push_back(handle);
+        resume(handle);
+    }
+
+    const std::int64_t untilNs = toNs(until);
+    auto lastWake              = clock_.now();
+
+    while (!stopRequested_.load(std::memory_order_relaxed) && !error_ &&
+           !heap_.empty()) {
+        std::int64_t deadlineNs = heap_.front().deadlineNs;
+        if (deadlineNs > untilNs) {
+            sleepUntilAbsolute(until);
+            break;
+        }
+        if (deadlineNs > toNs(clock_.now())) {
+            lastWake = wait_.waitUntil(clock_, lastWake, fromNs(deadlineNs),
+                                       false);
+        }
+
+        std::pop_heap(heap_.begin(), heap_.end(), Later{});
+        Pending due = heap_.back();
+        heap_.pop_back();
+
+        auto resumedAt        = clock_.now();
+        std::int64_t lateness = toNs(resumedAt) - due.deadlineNs;
+        due.ticker->lateness_.record(
+            lateness > 0 ? static_cast<std::uint64_t>(lateness) : 0);
+        due.ticker->last_ = {due.ticker->index_, fromNs(due.deadlineNs),
+                             std::chrono::nanoseconds(lateness)};
+        resume(due.handle);
+        clock_.resyncIfDue(resumedAt);
+    }
+
+    wait_.end();
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_                   = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+namespace {
+
+PeriodicTask tickForever(Ticker& ticker) {
+    for (;;) {
+        co_await ticker.next();
+    }
+}
+
+}  // anonymous namespace
+
+void runCoroutineTickers(double intervalSec, std::size_t count,
+                         std::size_t intervals) {
+    using namespace std::chrono;
+
+    constexpr int kRates               = 4;
+    constexpr std::size_t kWorstToShow = 10;
+    constexpr int kHistogramBits       = 7;
+
+    auto interval = nanoseconds(static_cast<long long>(intervalSec * 1e9));
+
+    CoroExecutor executor(interval, count);
+    std::vector<std::unique_ptr<Ticker>> tickers;
+    tickers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        tickers.push_back(std::make_unique<Ticker>(
+            executor, interval * static_cast<long long>(1 + i % kRates),
+            kHistogramBits));
+        executor.spawn(tickForever(*tickers.back()));
+    }
+
+    executor.run(executor.now() +
+                 interval * static_cast<long long>(intervals));
+
+    LatencyHistogram aggregate(LatencyHistogram::kDefaultHighestTrackable,
+                               kHistogramBits);
+    std::vector<std::pair<double, std::size_t>> worst;
+    worst.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        aggregate.merge(tickers[i]->lateness());
+        worst.emplace_back(static_cast<double>(
+                               tickers[i]->lateness().valueAtPercentile(0.99)),
+                           i);
+    }
+    std::size_t shown = std::min(kWorstToShow, worst.size());
+    std::partial_sort(worst.begin(), worst.begin() + shown, worst.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.first > b.first;
+                      });
+
+    ::utils::TimingStats all = makeTimingStats(aggregate, 1e3);
+    AdaptiveSpinScheduler::Report sched = executor.schedulerReport();
+
+    logger << std::fixed << std::setprecision(2);
+    logger << "\n========== Coroutine Ticker Lateness (us) ==========\n"
+           << "Coroutines: " << count << "\n"
+           << "Resumptions: " << executor.resumptions() << "\n"
+           << "Lateness average (us): " << all.average << "\n"
+           << "Lateness 50th Percentile (us): " << all.p50 << "\n"
+           << "Lateness 99th Percentile (us): " << all.p99 << "\n"
+           << "Lateness 99.9th Percentile (us): " << all.p999 << "\n"
+           << "Lateness 99.99th Percentile (us): " << all.p9999 << "\n"
+           << "Executor time sleeping (ms): "
+           << duration<double, std::milli>(sched.sleepTime).count() << "\n"
+           << "Executor time spinning (ms): "
+           << duration<double, std::milli>(sched.spinTime).count() << "\n"
+           << "Worst coroutines by p99 lateness:\n";
+    for (std::size_t k = 0; k < shown; ++k) {
+        std::size_t i          = worst[k].second;
+        ::utils::TimingStats s = tickers[i]->latenessStats(1e3);
+        logger << "  coroutine " << i << " (period "
+               << duration<double, std::micro>(tickers[i]->period()).count()
+               << " us): p50 " << s.p50 << ", p99 " << s.p99 << "\n";
+    }
+    logger << "====================================================\n";
+}
+
+}  // namespace ts
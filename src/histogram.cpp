@@ -0,0 +1,163 @@
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ts {
+
+LatencyHistogram::LatencyHistogram(std::uint64_t highestTrackableValue,
+                                   int significantBits)
+    : significantBits_(significantBits),
+      subBucketCount_(0),
+      subBucketHalfCount_(0),
+      highestTrackable_(highestTrackableValue) {
+    if (significantBits < 2 || significantBits > 20) {
+        throw std::invalid_argument(
+            "Histogram precision must be between 2 and 20 bits");
+    }
+    subBucketCount_     = 1ULL << significantBits_;
+    subBucketHalfCount_ = subBucketCount_ / 2;
+    if (highestTrackable_ < subBucketCount_) {
+        highestTrackable_ = subBucketCount_;
+    }
+    counts_.assign(indexFor(highestTrackable_) + 1, 0);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.significantBits_ != significantBits_ ||
+        other.counts_.size() != counts_.size()) {
+        throw std::invalid_argument("Cannot merge histograms with different "
+                                    "precision or range");
+    }
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    totalCount_ += other.totalCount_;
+    overflowCount_ += other.overflowCount_;
+    sum_ += other.sum_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+}
+
+void LatencyHistogram::subtract(const LatencyHistogram& other) {
+    if (other.significantBits_ != significantBits_ ||
+        other.counts_.size() != counts_.size()) {
+        throw std::invalid_argument("Cannot subtract histograms with "
+                                    "different precision or range");
+    }
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] -= other.counts_[i];
+    }
+    totalCount_ -= other.totalCount_;
+    overflowCount_ -= other.overflowCount_;
+    sum_ -= other.sum_;
+    if (totalCount_ == 0) {
+        min_ = UINT64_MAX;
+        max_ = 0;
+    }
+}
+
+void LatencyHistogram::reset() noexcept {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    totalCount_    = 0;
+    overflowCount_ = 0;
+    sum_           = 0;
+    min_           = UINT64_MAX;
+    max_           = 0;
+}
+
+std::uint64_t LatencyHistogram::lowestValueAt(std::size_t index) const
+    noexcept {
+    if (index < subBucketCount_) {
+        return index;
+    }
+    std::uint64_t offset = index - subBucketCount_;
+    int shift = static_cast<int>(offset / subBucketHalfCount_) + 1;
+    return (subBucketHalfCount_ + offset % subBucketHalfCount_) << shift;
+}
+
+std::uint64_t LatencyHistogram::bucketWidthAt(std::size_t index) const
+    noexcept {
+    if (index < subBucketCount_) {
+        return 1;
+    }
+    std::uint64_t offset = index - subBucketCount_;
+    return 1ULL << (offset / subBucketHalfCount_ + 1);
+}
+
+std::uint64_t LatencyHistogram::valueAtPercentile(double p) const {
+    if (totalCount_ == 0) return 0;
+
+    // Same rank convention as utils::calculatePercentile on sorted data
+    std::uint64_t rank = static_cast<std::uint64_t>(
+        std::clamp(p, 0.0, 1.0) * static_cast<double>(totalCount_));
+    if (rank >= totalCount_) rank = totalCount_ - 1;
+
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        cumulative += counts_[i];
+        if (cumulative > rank) {
+            return std::clamp(representativeAt(i), min(), max_);
+        }
+    }
+    return max_;
+}
+
+double LatencyHistogram::stddev() const {
+    if (totalCount_ == 0) return 0.0;
+
+    double mean     = this->mean();
+    double variance = 0.0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] == 0) continue;
+        double deviation = static_cast<double>(representativeAt(i)) - mean;
+        variance += static_cast<double>(counts_[i]) * deviation * deviation;
+    }
+    return std::sqrt(variance / static_cast<double>(totalCount_));
+}
+
+double LatencyHistogram::meanAbsDeviation(std::uint64_t reference) const {
+    if (totalCount_ == 0) return 0.0;
+
+    double sum = 0.0;
+    for (std::size_t i = 0; i < counts_.size(); ++i) {
+        if (counts_[i] == 0) continue;
+        double value = static_cast<double>(representativeAt(i));
+        sum += static_cast<double>(counts_[i]) *
+               std::fabs(value - static_cast<double>(reference));
+    }
+    return sum / static_cast<double>(totalCount_);
+}
+
+::utils::TimingStats makeTimingStats(const LatencyHistogram& histogram,
+                                     double nanosecondsPerUnit,
+                                     std::int64_t targetNs) {
+    auto at = [&](double p) {
+        return static_cast<double>(histogram.valueAtPercentile(p)) /
+               nanosecondsPerUnit;
+    };
+
+    ::utils::TimingStats stats{};
+    stats.count   = static_cast<std::size_t>(histogram.count());
+    stats.average = histogram.mean() / nanosecondsPerUnit;
+    stats.p50     = at(0.50);
+    stats.p75     = at(0.75);
+    stats.p90     = at(0.90);
+    stats.p95     = at(0.95);
+    stats.p99     = at(0.99);
+    stats.p999    = at(0.999);
+    stats.p9999   = at(0.9999);
+    stats.stddev  = histogram.stddev() / nanosecondsPerUnit;
+    stats.min = static_cast<double>(histogram.min()) / nanosecondsPerUnit;
+    stats.max = static_cast<double>(histogram.max()) / nanosecondsPerUnit;
+    stats.meanAbsDeviation =
+        targetNs > 0 ? histogram.meanAbsDeviation(
+                           static_cast<std::uint64_t>(targetNs)) /
+                           nanosecondsPerUnit
+                     : std::nan("");
+    stats.maxJitter = std::nan("");
+    return stats;
+}
+
+}  // namespace ts
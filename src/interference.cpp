@@ -0,0 +1,154 @@
+#include "interference.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <variant>
+
+#include "histogram.hpp"
+#include "logger.hpp"
+
+namespace ts {
+
+namespace {
+
+// Time the stressors get to allocate and first touch their buffers before
+// the timer starts
+constexpr auto kWarmup = std::chrono::milliseconds(200);
+
+}  // anonymous namespace
+
+InterferenceRunner::InterferenceRunner(const Options& options)
+    : options_(options), stressors_(options.stressors) {
+    if (stressors_.empty()) {
+        throw std::invalid_argument("Interference needs a stressor");
+    }
+    for (StressorSpec& spec : stressors_) {
+        if (!spec.sibling) {
+            continue;
+        }
+        int cpu = options_.realtime.timingCpu;
+        if (cpu < 0) {
+            throw std::invalid_argument(spec.label +
+                                        " needs --timing-cpu");
+        }
+        spec.cpus = smtSiblingsOf(cpu);
+        if (spec.cpus.empty()) {
+            throw std::invalid_argument("CPU " + std::to_string(cpu) +
+                                        " has no SMT sibling for " +
+                                        spec.label);
+        }
+    }
+
+    // Phases are reported in one table, not tick by tick
+    timer_ = createTimer(options_);
+    baseTimer(timer_).setTickOutput(false);
+}
+
+std::vector<InterferencePhase> InterferenceRunner::run() {
+    std::vector<std::pair<std::string, std::vector<StressorSpec>>> plan;
+    plan.push_back({"baseline", {}});
+    for (const StressorSpec& spec : stressors_) {
+        plan.push_back({spec.label, {spec}});
+    }
+    if (stressors_.size() > 1) {
+        plan.push_back({"all", stressors_});
+    }
+
+    std::vector<InterferencePhase> phases;
+    for (std::size_t i = 0; i < plan.size(); ++i) {
+        if (stopRequested_.load(std::memory_order_relaxed)) {
+            break;
+        }
+        logger << "Interference phase " << i + 1 << "/" << plan.size()
+               << ": " << plan[i].first << "\n";
+        InterferencePhase phase = runPhase(plan[i].first, plan[i].second);
+        if (phase.lateness.count > 0) {
+            phases.push_back(std::move(phase));
+        }
+    }
+    return phases;
+}
+
+InterferencePhase InterferenceRunner::runPhase(
+    const std::string& label, const std::vector<StressorSpec>& specs) {
+    std::vector<std::unique_ptr<StressorGroup>> groups;
+    for (const StressorSpec& spec : specs) {
+        groups.push_back(std::make_unique<StressorGroup>(spec));
+        groups.back()->start();
+    }
+    if (!groups.empty()) {
+        std::this_thread::sleep_for(kWarmup);
+    }
+
+    BaseTimer& timer = baseTimer(timer_);
+    std::visit([&](auto& t) { t->run(options_.iterations); }, timer_);
+
+    std::ostringstream load;
+    load << std::fixed << std::setprecision(1);
+    for (std::unique_ptr<StressorGroup>& group : groups) {
+        double rate = group->stop();
+        load << (load.tellp() > 0 ? ", " : "")
+             << stressorKindName(group->spec().kind) << " " << rate << " "
+             << group->rateUnit();
+        for (const std::string& error : group->pinErrors()) {
+            logger << "Warning: " << group->spec().label
+                   << " thread not pinned: " << error << "\n";
+        }
+    }
+
+    InterferencePhase phase{label, {}, load.str()};
+    const LatencyHistogram& lateness = timer.getLatenessHistogram();
+    if (lateness.count() > 0) {
+        phase.lateness = makeTimingStats(lateness, 1e3);
+    }
+    return phase;
+}
+
+void InterferenceRunner::requestStop() {
+    stopRequested_.store(true, std::memory_order_relaxed);
+    baseTimer(timer_).requestStop();
+}
+
+void printInterferenceTable(const std::vector<InterferencePhase>& phases) {
+    if (phases.empty()) {
+        return;
+    }
+    // A stop during the baseline leaves nothing to compare with
+    const bool haveBaseline              = phases.front().label == "baseline";
+    const ::utils::TimingStats& baseline = phases.front().lateness;
+    auto change = [haveBaseline](double value, double reference) {
+        std::ostringstream text;
+        if (haveBaseline) {
+            text << std::showpos << std::fixed << std::setprecision(2)
+                 << value - reference;
+        } else {
+            text << "n/a";
+        }
+        return text.str();
+    };
+
+    logger << std::fixed << std::setprecision(2);
+    logger << "\n========== Interference: tick lateness (us) ==========\n"
+           << std::left << std::setw(24) << "phase" << std::right
+           << std::setw(10) << "p50" << std::setw(10) << "p99"
+           << std::setw(10) << "p99.9" << std::setw(11) << "max"
+           << std::setw(11) << "p99 +/-" << std::setw(11) << "p99.9 +/-"
+           << "  load\n";
+    for (const InterferencePhase& phase : phases) {
+        const ::utils::TimingStats& s = phase.lateness;
+        logger << std::left << std::setw(24) << phase.label << std::right
+               << std::setw(10) << s.p50 << std::setw(10) << s.p99
+               << std::setw(10) << s.p999 << std::setw(11) << s.max
+               << std::setw(11) << change(s.p99, baseline.p99)
+               << std::setw(11) << change(s.p999, baseline.p999) << "  "
+               << (phase.load.empty() ? "-" : phase.load) << "\n";
+    }
+    logger << "=======================================================\n";
+}
+
+}  // namespace ts
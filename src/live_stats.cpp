@@ -0,0 +1,333 @@
+#include "live_stats.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+static_assert(std::is_trivially_copyable_v<LiveStats>,
+              "LiveStats is copied as raw words");
+static_assert(sizeof(LiveStats) % sizeof(std::uint64_t) == 0,
+              "LiveStats must be a whole number of words");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared-memory atomics must not hide a lock");
+
+constexpr std::size_t kStatsWords = sizeof(LiveStats) / sizeof(std::uint64_t);
+
+// Retries of a reader before it gives up on a snapshot
+constexpr int kReadAttempts = 1000;
+
+// The sequence number gets a cache line of its own, away from the header
+// readers check once
+struct Segment {
+    LiveStatsHeader header;
+    alignas(64) std::atomic<std::uint64_t> sequence;
+    std::atomic<std::uint64_t> words[kStatsWords];
+};
+
+std::string segmentName(const std::string& name) {
+    if (name.empty() || name == "/") {
+        throw std::invalid_argument("Live statistics need a segment name");
+    }
+    return name[0] == '/' ? name : "/" + name;
+}
+
+std::runtime_error segmentError(const std::string& what,
+                                const std::string& name) {
+    return std::runtime_error(what + ": " + name + " (" +
+                              std::strerror(errno) + ")");
+}
+
+void copyString(char* out, std::size_t size, const char* text) {
+    std::memset(out, 0, size);
+    std::strncpy(out, text, size - 1);
+}
+
+#ifndef _WIN32
+/**
+ * @brief Check that an existing segment was left behind by a process that
+ * no longer runs, so it may be replaced
+ * @throws std::runtime_error if its publisher is alive, or if it holds no
+ * complete live statistics header to tell
+ */
+void checkSegmentAbandoned(const std::string& name) {
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        // Unlinked in the meantime; the exclusive create will tell
+        return;
+    }
+    struct stat info {};
+    void* mapping = MAP_FAILED;
+    if (::fstat(fd, &info) == 0 &&
+        static_cast<std::size_t>(info.st_size) >= sizeof(LiveStatsHeader)) {
+        mapping = ::mmap(nullptr, sizeof(LiveStatsHeader), PROT_READ,
+                         MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error(
+            "Live statistics segment exists and is not readable: " + name);
+    }
+    LiveStatsHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    ::munmap(mapping, sizeof(LiveStatsHeader));
+
+    if (std::memcmp(header.magic, LiveStatsHeader::kMagic,
+                    sizeof(header.magic)) != 0) {
+        throw std::runtime_error(
+            "Shared-memory segment exists and is not a complete live "
+            "statistics segment: " +
+            name);
+    }
+    // EPERM still means the process exists, under another user
+    pid_t pid = static_cast<pid_t>(header.pid);
+    if (pid > 0 && (::kill(pid, 0) == 0 || errno != ESRCH)) {
+        throw std::runtime_error("Live statistics segment " + name +
+                                 " is in use by process " +
+                                 std::to_string(header.pid));
+    }
+}
+#endif
+
+}  // anonymous namespace
+
+LiveStatsPublisher::LiveStatsPublisher(const std::string& name,
+                                       std::chrono::nanoseconds window)
+    : name_(segmentName(name)),
+      window_(kHighestTrackableNs, kHistogramBits) {
+    if (window.count() < kWindowSlices) {
+        throw std::invalid_argument("Live statistics window is too short");
+    }
+    sliceNs_        = window.count() / kWindowSlices;
+    stats_.windowNs = sliceNs_ * kWindowSlices;
+    slices_.reserve(kWindowSlices);
+    for (int i = 0; i < kWindowSlices; ++i) {
+        slices_.emplace_back(kHighestTrackableNs, kHistogramBits);
+    }
+
+#ifndef _WIN32
+    // Created exclusively, so that a second timer cannot take over a live
+    // publisher's segment; one left behind by a crashed run is replaced
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        checkSegmentAbandoned(name_);
+        ::shm_unlink(name_.c_str());
+        fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+    if (fd < 0) {
+        throw segmentError("Failed to create live statistics segment", name_);
+    }
+    if (::ftruncate(fd, sizeof(Segment)) != 0) {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        throw segmentError("Failed to size live statistics segment", name_);
+    }
+    void* mapping = ::mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE,
+                           MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw segmentError("Failed to map live statistics segment", name_);
+    }
+    mapping_ = mapping;
+
+    Segment* segment = new (mapping) Segment;
+    std::memset(segment->header.magic, 0, sizeof(segment->header.magic));
+    segment->sequence.store(0, std::memory_order_relaxed);
+    for (std::atomic<std::uint64_t>& word : segment->words) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    segment->header.version   = LiveStatsHeader::kVersion;
+    segment->header.statsSize = sizeof(LiveStats);
+    segment->header.pid       = static_cast<std::int64_t>(::getpid());
+    // The magic goes last, so that readers never accept a half-written
+    // header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(segment->header.magic, LiveStatsHeader::kMagic,
+                sizeof(segment->header.magic));
+    sequence_ = &segment->sequence;
+    words_    = segment->words;
+#else
+    throw std::runtime_error(
+        "Live statistics need POSIX shared memory, which this platform "
+        "lacks");
+#endif
+}
+
+LiveStatsPublisher::~LiveStatsPublisher() {
+#ifndef _WIN32
+    if (mapping_ != nullptr) {
+        ::munmap(mapping_, sizeof(Segment));
+        ::shm_unlink(name_.c_str());
+    }
+#endif
+}
+
+void LiveStatsPublisher::begin(const char* clockName, const char* unit,
+                               std::int64_t intervalNs) {
+    for (LatencyHistogram& slice : slices_) {
+        slice.reset();
+    }
+    window_.reset();
+    current_    = 0;
+    sliceEndNs_ = INT64_MAX;
+
+    std::int64_t windowNs = stats_.windowNs;
+    stats_                = LiveStats{};
+    copyString(stats_.clockSource, sizeof(stats_.clockSource), clockName);
+    copyString(stats_.unit, sizeof(stats_.unit), unit);
+    stats_.running    = 1;
+    stats_.intervalNs = intervalNs;
+    stats_.windowNs   = windowNs;
+    publish();
+}
+
+void LiveStatsPublisher::start(std::int64_t startNs) {
+    sliceEndNs_ = startNs + sliceNs_;
+}
+
+void LiveStatsPublisher::end() {
+    stats_.running = 0;
+    publish();
+}
+
+void LiveStatsPublisher::closeSlices(std::int64_t nowNs) {
+    std::uint64_t windowMax = 0;
+    for (const LatencyHistogram& slice : slices_) {
+        windowMax = std::max(windowMax, slice.max());
+    }
+    auto at = [&](double p) {
+        return static_cast<std::int64_t>(
+            std::min(window_.valueAtPercentile(p), windowMax));
+    };
+    stats_.windowCount  = window_.count();
+    stats_.windowP50Ns  = at(0.50);
+    stats_.windowP99Ns  = at(0.99);
+    stats_.windowP999Ns = at(0.999);
+    stats_.windowMaxNs  = static_cast<std::int64_t>(windowMax);
+
+    // Each slice entered drops the oldest one out of the window; after a
+    // stall of a whole window every slice is empty
+    std::int64_t ended = (nowNs - sliceEndNs_) / sliceNs_ + 1;
+    for (std::int64_t i = 0; i < std::min<std::int64_t>(ended, kWindowSlices);
+         ++i) {
+        current_ = (current_ + 1) % kWindowSlices;
+        window_.subtract(slices_[current_]);
+        slices_[current_].reset();
+    }
+    sliceEndNs_ += ended * sliceNs_;
+}
+
+void LiveStatsPublisher::publish() {
+    if (words_ == nullptr) {
+        return;
+    }
+    std::uint64_t words[kStatsWords];
+    std::memcpy(words, &stats_, sizeof(words));
+
+    // Odd while the words change; the release fence keeps the stores below
+    // from becoming visible before the odd sequence number
+    std::uint64_t sequence = sequence_->load(std::memory_order_relaxed);
+    sequence_->store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (std::size_t i = 0; i < kStatsWords; ++i) {
+        words_[i].store(words[i], std::memory_order_relaxed);
+    }
+    sequence_->store(sequence + 2, std::memory_order_release);
+}
+
+LiveStatsReader::LiveStatsReader(const std::string& name)
+    : name_(segmentName(name)) {
+#ifndef _WIN32
+    int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw segmentError("Failed to open live statistics segment", name_);
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) < sizeof(Segment)) {
+        ::close(fd);
+        throw std::runtime_error("Not a live statistics segment: " + name_);
+    }
+    void* mapping =
+        ::mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw segmentError("Failed to map live statistics segment", name_);
+    }
+
+    // The destructor does not run for a constructor that throws
+    const LiveStatsHeader& header =
+        static_cast<const Segment*>(mapping)->header;
+    if (std::memcmp(header.magic, LiveStatsHeader::kMagic,
+                    sizeof(header.magic)) != 0) {
+        ::munmap(mapping, sizeof(Segment));
+        throw std::runtime_error("Not a live statistics segment: " + name_);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header.version != LiveStatsHeader::kVersion ||
+        header.statsSize != sizeof(LiveStats)) {
+        ::munmap(mapping, sizeof(Segment));
+        throw std::runtime_error("Unsupported live statistics segment: " +
+                                 name_);
+    }
+    mapping_ = mapping;
+#else
+    throw std::runtime_error(
+        "Live statistics need POSIX shared memory, which this platform "
+        "lacks");
+#endif
+}
+
+LiveStatsReader::~LiveStatsReader() {
+#ifndef _WIN32
+    if (mapping_ != nullptr) {
+        ::munmap(const_cast<void*>(mapping_), sizeof(Segment));
+    }
+#endif
+}
+
+bool LiveStatsReader::read(LiveStats& out) const {
+    const Segment* segment = static_cast<const Segment*>(mapping_);
+    std::uint64_t words[kStatsWords];
+
+    for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+        std::uint64_t before =
+            segment->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (std::size_t i = 0; i < kStatsWords; ++i) {
+            words[i] = segment->words[i].load(std::memory_order_relaxed);
+        }
+        // Keeps the word loads above from moving past the second read
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (segment->sequence.load(std::memory_order_relaxed) == before) {
+            std::memcpy(&out, words, sizeof(out));
+            return true;
+        }
+    }
+    return false;
+}
+
+std::int64_t LiveStatsReader::pid() const {
+    return static_cast<const Segment*>(mapping_)->header.pid;
+}
+
+}  // namespace ts
@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <ctime>
+#include <utility>
 #include <filesystem>
 #include <fstream>
 #include <iomanip>
@@ -11,7 +12,22 @@
 
 namespace logging {
 
-Logger::Logger(const std::string& folderPath) {
+namespace {
+
+std::uint64_t nextLoggerId() {
+    static std::atomic<std::uint64_t> counter{0};
+    return ++counter;
+}
+
+}  // anonymous namespace
+
+Logger::Logger() : id_(nextLoggerId()) {}
+
+Logger::Logger(const std::string& folderPath) : id_(nextLoggerId()) {
+    openFile(folderPath);
+}
+
+void Logger::openFile(const std::string& folderPath) {
     if (!checkFolderExists(folderPath)) {
         createFolder(folderPath);
     }
@@ -31,6 +47,9 @@ Logger::Logger(const std::string& folderPath) {
             folderPath + "/" + filename + "_" + std::to_string(i) + ".log";
     }
 
+    if (file.is_open()) {
+        file.close();
+    }
     file.open(fullPath, std::ios::out);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open log file: " + fullPath);
@@ -39,11 +58,201 @@ Logger::Logger(const std::string& folderPath) {
 }
 
 Logger::~Logger() {
+    if (isAsync()) {
+        // Thread-local buffer lookups are unsafe during static destruction,
+        // and every logging thread has finished: publish the unfinished
+        // lines of all of them directly
+        {
+            std::lock_guard<std::mutex> lock(registryMutex_);
+            for (auto& buffer : registry_) {
+                publish(*buffer);
+            }
+        }
+        stopDrainThread();
+    }
     if (logFileOpened && file.is_open()) {
         file.close();
     }
 }
 
+void Logger::setAsync(bool enabled, std::size_t memoryLimitBytes) {
+    memoryLimit_ = memoryLimitBytes;
+    if (enabled == isAsync()) {
+        return;
+    }
+
+    if (enabled) {
+        {
+            std::lock_guard<std::mutex> lock(drainMutex_);
+            stopDrain_ = false;
+        }
+        drainThread_ = std::thread(&Logger::drainLoop, this);
+        async_.store(true, std::memory_order_release);
+        return;
+    }
+
+    publish(threadBuffer());
+    stopDrainThread();
+}
+
+void Logger::stopDrainThread() {
+    {
+        std::lock_guard<std::mutex> lock(drainMutex_);
+        stopDrain_ = true;
+    }
+    drainCv_.notify_one();
+    drainThread_.join();
+    async_.store(false, std::memory_order_release);
+
+    std::uint64_t dropped = droppedBytes();
+    if (dropped > 0) {
+        std::cerr << "Warning: async logger dropped " << dropped
+                  << " bytes at its memory limit\n";
+    }
+}
+
+void Logger::flush() {
+    if (!isAsync()) {
+        if (console_ != nullptr) {
+            console_->flush();
+        }
+        if (logFileOpened && file.is_open()) {
+            file.flush();
+        }
+        return;
+    }
+
+    publish(threadBuffer());
+
+    std::unique_lock<std::mutex> lock(drainMutex_);
+    std::uint64_t ticket = ++flushRequested_;
+    drainCv_.notify_one();
+    flushedCv_.wait(lock, [&] { return flushCompleted_ >= ticket; });
+}
+
+Logger::ThreadBuffer& Logger::threadBuffer() {
+    // A thread may log to several loggers; the list is almost always one
+    // entry long. Entries outlive a destroyed logger harmlessly because
+    // logger ids are never reused.
+    thread_local std::vector<
+        std::pair<std::uint64_t, std::shared_ptr<ThreadBuffer>>>
+        buffers;
+    for (auto& [id, buffer] : buffers) {
+        if (id == id_) {
+            return *buffer;
+        }
+    }
+
+    auto buffer = std::make_shared<ThreadBuffer>();
+    {
+        std::lock_guard<std::mutex> lock(registryMutex_);
+        registry_.push_back(buffer);
+    }
+    buffers.emplace_back(id_, buffer);
+    return *buffer;
+}
+
+void Logger::publish(ThreadBuffer& buffer) {
+    std::string& console  = buffer.consoleSink.text;
+    std::string& fileText = buffer.fileSink.text;
+    std::size_t bytes     = console.size() + fileText.size();
+    if (bytes == 0) {
+        return;
+    }
+
+    std::size_t pending = pendingBytes_.load(std::memory_order_relaxed);
+    if (pending + bytes > memoryLimit_) {
+        droppedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+        console.clear();
+        fileText.clear();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.pendingConsole.append(console);
+        buffer.pendingFile.append(fileText);
+    }
+    console.clear();
+    fileText.clear();
+
+    pending = pendingBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    if (pending < kBatchBytes && pending + bytes >= kBatchBytes) {
+        drainCv_.notify_one();
+    }
+}
+
+void Logger::drainLoop() {
+    // Wake at least this often so that short records are not held back
+    constexpr auto kDrainPeriod = std::chrono::milliseconds(50);
+
+    std::unique_lock<std::mutex> lock(drainMutex_);
+    while (true) {
+        drainCv_.wait_for(lock, kDrainPeriod, [&] {
+            return stopDrain_ || flushRequested_ != flushCompleted_ ||
+                   pendingBytes_.load(std::memory_order_relaxed) >=
+                       kBatchBytes;
+        });
+        bool stopping        = stopDrain_;
+        std::uint64_t target = flushRequested_;
+
+        lock.unlock();
+        drainOnce();
+        lock.lock();
+
+        flushCompleted_ = target;
+        flushedCv_.notify_all();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void Logger::drainOnce() {
+    {
+        std::lock_guard<std::mutex> registryLock(registryMutex_);
+        for (std::size_t i = 0; i < registry_.size();) {
+            ThreadBuffer& buffer = *registry_[i];
+            // Only the registry still holds buffers of exited threads; check
+            // before the swap so that their last records are not lost
+            bool orphaned = registry_[i].use_count() == 1;
+            {
+                // Double buffering: hand the producer an empty string with
+                // spare capacity and format nothing while holding its lock
+                std::lock_guard<std::mutex> lock(buffer.mutex);
+                std::swap(buffer.pendingConsole, spareConsole_);
+                std::swap(buffer.pendingFile, spareFile_);
+            }
+            batchConsole_.append(spareConsole_);
+            batchFile_.append(spareFile_);
+            spareConsole_.clear();
+            spareFile_.clear();
+
+            if (orphaned) {
+                registry_[i] = std::move(registry_.back());
+                registry_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    std::size_t written = batchConsole_.size() + batchFile_.size();
+    if (!batchConsole_.empty() && console_ != nullptr) {
+        console_->write(batchConsole_.data(),
+                        static_cast<std::streamsize>(batchConsole_.size()));
+        console_->flush();
+    }
+    if (!batchFile_.empty() && file.is_open()) {
+        file.write(batchFile_.data(),
+                   static_cast<std::streamsize>(batchFile_.size()));
+        file.flush();
+    }
+    batchConsole_.clear();
+    batchFile_.clear();
+    pendingBytes_.fetch_sub(written, std::memory_order_relaxed);
+}
+
 std::string Logger::generateFilenameWithoutExtension() {
     auto now      = std::chrono::system_clock::now();
     std::time_t t = std::chrono::system_clock::to_time_t(now);
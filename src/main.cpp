@@ -1,48 +1,183 @@
+#include <csignal>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <variant>
 
-#include "base_timer.hpp"
-#include "high_res_timer.hpp"
+#include "interference.hpp"
 #include "logger.hpp"
-#include "timer.hpp"
-
-void printUsage(const char* programName) {
-    std::cerr
-        << "Usage: " << programName << " <seconds>\n"
-        << "  seconds: Target interval duration in seconds (positive number, "
-           "supports sub-millisecond)\n"
-        << "Example: " << programName << " 0.001  # 1ms interval\n"
-        << "         " << programName << " 0.0001 # 100us interval\n";
+#include "multi_core_engine.hpp"
+#include "noise_detector.hpp"
+#include "options.hpp"
+#include "sweep.hpp"
+#include "timer_factory.hpp"
+#include "timing_wheel.hpp"
+
+#ifdef TS_HAVE_COROUTINES
+#include "coro_executor.hpp"
+#endif
+
+namespace {
+
+ts::BaseTimer* runningTimer                 = nullptr;
+ts::SweepRunner* runningSweep               = nullptr;
+ts::InterferenceRunner* runningInterference = nullptr;
+
+// Ends the run after the current tick so that its statistics are still
+// reported; a second signal terminates as usual
+extern "C" void stopRunningTimer(int) {
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    if (runningSweep) {
+        runningSweep->requestStop();
+    } else if (runningInterference) {
+        runningInterference->requestStop();
+    } else {
+        runningTimer->requestStop();
+    }
 }
 
+}  // anonymous namespace
+
 int main(int argc, char* argv[]) {
     try {
-        if (argc != 2) {
-            printUsage(argv[0]);
+        if (argc < 2) {
+            ts::printUsage(argv[0]);
             return 1;
         }
 
-        double intervalSec = ::utils::parseInterval(argv[1]);
+        logger.openFile("logs");
+
+        ts::Options options = ts::parseOptions(argc, argv);
+        double intervalSec  = options.intervalSec;
+
+#ifndef TS_ENABLE_TRACE
+        if (!options.tracePath.empty()) {
+            throw std::invalid_argument(
+                "--trace needs a build with -DTIMESTAMP_ENABLE_TRACE=ON");
+        }
+#endif
+
+        if (options.asyncLog) {
+            logger.setAsync(true);
+        }
+
+        if (!options.sweepIntervals.empty()) {
+            ts::SweepRunner sweep(options);
+            runningSweep = &sweep;
+            std::signal(SIGINT, stopRunningTimer);
+            std::signal(SIGTERM, stopRunningTimer);
+            std::vector<ts::SweepResult> results = sweep.run();
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+            runningSweep = nullptr;
+
+            ts::printSweepTable(results);
+            if (!options.sweepReportPath.empty()) {
+                ts::writeSweepReport(results, options.sweepReportPath);
+                logger << "Sweep report: " << options.sweepReportPath << "\n";
+            }
+            return 0;
+        }
+
+        if (!options.stressors.empty()) {
+            ts::InterferenceRunner interference(options);
+            runningInterference = &interference;
+            std::signal(SIGINT, stopRunningTimer);
+            std::signal(SIGTERM, stopRunningTimer);
+            std::vector<ts::InterferencePhase> phases = interference.run();
+            std::signal(SIGINT, SIG_DFL);
+            std::signal(SIGTERM, SIG_DFL);
+            runningInterference = nullptr;
+
+            ts::printInterferenceTable(phases);
+            return 0;
+        }
+
+        if (options.wheelProbes > 0) {
+            logger << "interval = " << intervalSec << " s\n";
+            ts::runWheelProbes(intervalSec,
+                               static_cast<std::size_t>(options.wheelProbes),
+                               options.iterations, options.spinPolicy);
+            return 0;
+        }
+
+        if (options.coroutineTickers > 0) {
+#ifdef TS_HAVE_COROUTINES
+            logger << "interval = " << intervalSec << " s\n";
+            ts::runCoroutineTickers(
+                intervalSec,
+                static_cast<std::size_t>(options.coroutineTickers),
+                options.iterations);
+            return 0;
+#else
+            throw std::invalid_argument(
+                "--coroutines needs a build with "
+                "-DTIMESTAMP_ENABLE_COROUTINES=ON");
+#endif
+        }
+
+        if (!options.cores.empty()) {
+            ts::MultiCoreEngine engine(options, options.cores);
+            engine.run(options.iterations);
+            logger << "interval = " << intervalSec << " s, "
+                   << options.cores.size() << " cores\n";
+            engine.printReport();
+            return 0;
+        }
 
-        std::unique_ptr<ts::BaseTimer> timer;
-        if (intervalSec < 0.002) {
-            timer = std::make_unique<ts::HighResTimer>(intervalSec);
-        } else {
-            timer = std::make_unique<ts::Timer>(intervalSec);
+        auto noiseThreshold = std::chrono::nanoseconds(
+            static_cast<long long>(options.noiseThresholdSec * 1e9));
+        std::unique_ptr<ts::NoiseDetector> noise;
+        if (options.noiseCpu >= 0) {
+            ts::NoiseDetectorOptions noiseOptions;
+            noiseOptions.cpu       = options.noiseCpu;
+            noiseOptions.threshold = noiseThreshold;
+            noiseOptions.clockKind = options.clockKind;
+            noise = std::make_unique<ts::NoiseDetector>(noiseOptions);
         }
 
-        timer->run();
+        // Thin dispatch onto the pre-instantiated timer specializations
+        ts::AnyTimer anyTimer = ts::createTimer(options);
+        std::visit(
+            [&](auto& timer) {
+                runningTimer = timer.get();
+                std::signal(SIGINT, stopRunningTimer);
+                std::signal(SIGTERM, stopRunningTimer);
+                if (noise) {
+                    noise->start();
+                }
+                timer->run(options.iterations);
+                if (noise) {
+                    noise->stop();
+                }
+                std::signal(SIGINT, SIG_DFL);
+                std::signal(SIGTERM, SIG_DFL);
 
-        auto stats = timer->calculateStatistics();
-        logger << "interval = " << intervalSec << " s\n";
-        timer->printStatistics(stats);
+                auto stats = timer->calculateStatistics();
+                logger << "interval = " << intervalSec << " s\n";
+                timer->printStatistics(stats);
+                if (noise) {
+                    ts::printNoiseReport(
+                        *noise, ts::attributeLateness(*noise, *timer,
+                                                      noiseThreshold));
+                }
+#ifdef TS_ENABLE_TRACE
+                if (!options.tracePath.empty()) {
+                    timer->writeTrace(options.tracePath);
+                    logger << "Tick trace: " << options.tracePath << " ("
+                           << timer->getTrace().size()
+                           << " ticks, Chrome trace JSON)\n";
+                }
+#endif
+            },
+            anyTimer);
 
         return 0;
 
     } catch (const std::invalid_argument& e) {
         std::cerr << "Error: " << e.what() << "\n";
-        printUsage(argv[0]);
+        ts::printUsage(argv[0]);
         return 1;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
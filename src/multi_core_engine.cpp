@@ -0,0 +1,209 @@
+#include "multi_core_engine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "histogram.hpp"
+#include "logger.hpp"
+#include "realtime.hpp"
+
+namespace ts {
+
+namespace {
+
+// A core is flagged as noisy when its p99 exceeds the median core's p99
+// by this factor
+constexpr double kNoisyCoreFactor = 1.5;
+
+// "run.bin" becomes "run-cpu3.bin"; the suffix goes before the extension
+// of the file name, not of a directory
+std::string perCorePath(const std::string& path, int cpu) {
+    std::string suffix = "-cpu" + std::to_string(cpu);
+    std::size_t dot    = path.rfind('.');
+    std::size_t slash  = path.find_last_of("/\\");
+    std::size_t start  = slash == std::string::npos ? 0 : slash + 1;
+    bool hasExtension  = dot != std::string::npos && dot > start;
+    return hasExtension ? path.substr(0, dot) + suffix + path.substr(dot)
+                        : path + suffix;
+}
+
+}  // anonymous namespace
+
+MultiCoreEngine::MultiCoreEngine(const Options& options, std::vector<int> cpus)
+    : cpus_(std::move(cpus)) {
+    if (cpus_.empty()) {
+        throw std::invalid_argument("Multi-core engine needs at least one CPU");
+    }
+
+    // The engine pins every thread itself and prints nothing per tick
+    Options perCore            = options;
+    perCore.realtime.timingCpu = -1;
+    perCore.realtime.outputCpu = -1;
+
+    timers_.reserve(cpus_.size());
+    for (std::size_t i = 0; i < cpus_.size(); ++i) {
+        if (!options.liveStatsName.empty()) {
+            // One segment per core, e.g. "timer-cpu3"
+            perCore.liveStatsName =
+                options.liveStatsName + "-cpu" + std::to_string(cpus_[i]);
+        }
+        if (!options.capturePath.empty()) {
+            // A shared file would be truncated and mapped by every core
+            perCore.capturePath = perCorePath(options.capturePath, cpus_[i]);
+        }
+        timers_.push_back(createTimer(perCore));
+        baseTimer(timers_.back()).setTickOutput(false);
+    }
+    pinErrors_.resize(cpus_.size());
+}
+
+void MultiCoreEngine::run(std::size_t iterations) {
+    std::atomic<std::size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::exception_ptr> errors(timers_.size());
+    std::vector<std::thread> threads;
+    threads.reserve(timers_.size());
+
+    for (std::size_t i = 0; i < timers_.size(); ++i) {
+        threads.emplace_back([&, i] {
+            pinErrors_[i].clear();
+            pinCurrentThread(cpus_[i], pinErrors_[i]);
+
+            ready.fetch_add(1, std::memory_order_acq_rel);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            try {
+                std::visit([&](auto& timer) { timer->run(iterations); },
+                           timers_[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+
+    while (ready.load(std::memory_order_acquire) < timers_.size()) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    for (const std::exception_ptr& e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+std::vector<MultiCoreEngine::CoreResult> MultiCoreEngine::results() const {
+    std::vector<CoreResult> out;
+    out.reserve(timers_.size());
+    for (std::size_t i = 0; i < timers_.size(); ++i) {
+        out.push_back({cpus_[i], pinErrors_[i].empty(), pinErrors_[i],
+                       baseTimer(timers_[i]).calculateStatistics()});
+    }
+    return out;
+}
+
+::utils::TimingStats MultiCoreEngine::mergedStatistics() const {
+    LatencyHistogram merged;
+    for (const auto& timer : timers_) {
+        merged.merge(baseTimer(timer).getHistogram());
+    }
+    if (merged.count() == 0) {
+        throw std::runtime_error("No intervals collected");
+    }
+    const BaseTimer& first = baseTimer(timers_.front());
+    return makeTimingStats(merged, first.getNanosecondsPerUnit(),
+                           first.getInterval().count());
+}
+
+void MultiCoreEngine::printReport() const {
+    const std::string unit        = baseTimer(timers_.front()).getUnit();
+    std::vector<CoreResult> cores = results();
+
+    std::vector<double> p99s;
+    for (const CoreResult& core : cores) {
+        p99s.push_back(core.stats.p99);
+    }
+    std::nth_element(p99s.begin(), p99s.begin() + p99s.size() / 2,
+                     p99s.end());
+    double medianP99 = p99s[p99s.size() / 2];
+
+    auto row = [&](const std::string& label, const ::utils::TimingStats& s) {
+        logger << std::setw(6) << label << std::setw(10) << s.count
+               << std::setw(12) << s.average << std::setw(12) << s.p50
+               << std::setw(12) << s.p99 << std::setw(12) << s.p999
+               << std::setw(12) << s.p9999;
+    };
+
+    logger << std::fixed << std::setprecision(2);
+    logger << "\n========== Per-Core Timing Statistics (" << unit
+           << ") ==========\n"
+           << std::setw(6) << "CPU" << std::setw(10) << "count"
+           << std::setw(12) << "average" << std::setw(12) << "p50"
+           << std::setw(12) << "p99" << std::setw(12) << "p99.9"
+           << std::setw(12) << "p99.99"
+           << "\n";
+    for (const CoreResult& core : cores) {
+        row(std::to_string(core.cpu), core.stats);
+        if (!core.pinned) {
+            logger << "  (not pinned: " << core.pinError << ")";
+        } else if (core.stats.p99 > medianP99 * kNoisyCoreFactor) {
+            logger << "  <- noisy";
+        }
+        logger << "\n";
+    }
+    row("all", mergedStatistics());
+    logger << "\n=====================================================\n";
+}
+
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    if (list == "all") {
+        unsigned int n = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int i = 0; i < n; ++i) {
+            cpus.push_back(static_cast<int>(i));
+        }
+        return cpus;
+    }
+
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        std::istringstream range(item);
+        int first = -1;
+        int last  = -1;
+        char dash = 0;
+        range >> first;
+        if (!range.eof()) {
+            range >> dash >> last;
+        } else {
+            last = first;
+        }
+        if (range.fail() || !range.eof() || (dash != 0 && dash != '-') ||
+            first < 0 || last < first) {
+            throw std::invalid_argument("Invalid CPU list: " + list);
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        throw std::invalid_argument("Invalid CPU list: " + list);
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+}  // namespace ts
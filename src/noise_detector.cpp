@@ -0,0 +1,353 @@
+#include "noise_detector.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include "logger.hpp"
+#include "realtime.hpp"
+
+namespace ts {
+
+namespace {
+
+std::int64_t sinceEpochNs(std::chrono::steady_clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               tp.time_since_epoch())
+        .count();
+}
+
+/** @brief Interrupts taken by one CPU so far, from /proc/interrupts */
+long long readInterrupts(int cpu) {
+#ifdef __linux__
+    std::ifstream in("/proc/interrupts");
+    std::string header;
+    if (cpu < 0 || !std::getline(in, header)) {
+        return -1;
+    }
+
+    // The header names one column per online CPU
+    std::istringstream columns(header);
+    std::string name;
+    int column = -1;
+    for (int i = 0; columns >> name; ++i) {
+        if (name == "CPU" + std::to_string(cpu)) {
+            column = i;
+            break;
+        }
+    }
+    if (column < 0) {
+        return -1;
+    }
+
+    long long total = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        fields >> name;
+        // ERR and MIS hold a single system-wide count
+        if (name == "ERR:" || name == "MIS:") {
+            continue;
+        }
+        long long count = 0;
+        for (int i = 0; i <= column && fields >> count; ++i) {
+        }
+        if (fields) {
+            total += count;
+        }
+    }
+    return total;
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+/** @brief MSR_SMI_COUNT of a CPU, or -1 without the msr driver or root */
+long long readSmiCount(int cpu) {
+#ifdef __linux__
+    constexpr off_t kMsrSmiCount = 0x34;
+
+    std::string path =
+        "/dev/cpu/" + std::to_string(std::max(cpu, 0)) + "/msr";
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    std::uint64_t value = 0;
+    ssize_t bytes       = ::pread(fd, &value, sizeof(value), kMsrSmiCount);
+    ::close(fd);
+    if (bytes != static_cast<ssize_t>(sizeof(value))) {
+        return -1;
+    }
+    return static_cast<long long>(value & 0xffffffffu);
+#else
+    (void)cpu;
+    return -1;
+#endif
+}
+
+/** @brief Involuntary context switches of the calling thread */
+long involuntarySwitches() {
+#ifdef __linux__
+    rusage usage{};
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_nivcsw;
+#else
+    return 0;
+#endif
+}
+
+}  // anonymous namespace
+
+NoiseDetector::NoiseDetector(const NoiseDetectorOptions& options)
+    : options_(options), clock_(options.clockKind) {
+    if (options_.threshold.count() <= 0) {
+        throw std::invalid_argument("Noise threshold must be positive");
+    }
+    gaps_.reserve(options_.maxGaps);
+}
+
+NoiseDetector::~NoiseDetector() {
+    stop();
+}
+
+void NoiseDetector::start() {
+    stop();
+    gaps_.clear();
+    droppedGaps_ = 0;
+    samples_     = 0;
+    pinError_.clear();
+    interrupts_ = readInterrupts(options_.cpu);
+    smis_       = readSmiCount(options_.cpu);
+
+    stopRequested_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread(&NoiseDetector::loop, this);
+}
+
+void NoiseDetector::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    stopRequested_.store(true, std::memory_order_relaxed);
+    thread_.join();
+
+    long long interrupts = readInterrupts(options_.cpu);
+    interrupts_ = interrupts >= 0 && interrupts_ >= 0
+                      ? interrupts - interrupts_
+                      : -1;
+    long long smis = readSmiCount(options_.cpu);
+    smis_          = smis >= 0 && smis_ >= 0 ? smis - smis_ : -1;
+}
+
+void NoiseDetector::loop() {
+    if (options_.cpu >= 0) {
+        pinCurrentThread(options_.cpu, pinError_);
+    }
+
+    const std::int64_t thresholdNs = options_.threshold.count();
+    long switches                  = involuntarySwitches();
+    std::uint64_t samples          = 0;
+
+    std::int64_t previousNs = sinceEpochNs(clock_.now());
+    startNs_                = previousNs;
+    while (!stopRequested_.load(std::memory_order_relaxed)) {
+        ClockSource::time_point now = clock_.now();
+        std::int64_t nowNs          = sinceEpochNs(now);
+        ++samples;
+        if (nowNs - previousNs > thresholdNs) {
+            long nowSwitches = involuntarySwitches();
+            if (gaps_.size() < gaps_.capacity()) {
+                gaps_.push_back(
+                    {previousNs, nowNs - previousNs, nowSwitches != switches});
+            } else {
+                ++droppedGaps_;
+            }
+            switches = nowSwitches;
+            // Keep the bookkeeping out of the next gap
+            nowNs = sinceEpochNs(clock_.now());
+        }
+        if (clock_.resyncIfDue(now)) {
+            // Nor the resync, which is not host noise
+            nowNs = sinceEpochNs(clock_.now());
+        }
+        previousNs = nowNs;
+    }
+    endNs_   = previousNs;
+    samples_ = samples;
+}
+
+NoiseAttribution attributeLateness(const NoiseDetector& detector,
+                                   const BaseTimer& timer,
+                                   std::chrono::nanoseconds lateThreshold) {
+    NoiseAttribution result;
+    const ArenaVector<std::int64_t>& intervals = timer.getIntervals();
+    if (intervals.empty()) {
+        return result;
+    }
+    result.available = true;
+    result.ticks     = intervals.size();
+
+    const std::vector<NoiseGap>& gaps = detector.gaps();
+    const std::int64_t targetNs       = timer.getInterval().count();
+    const std::int64_t startNs        = timer.getStartSteadyTime();
+
+    std::size_t firstGap    = 0;
+    std::int64_t previousNs = startNs;
+    std::int64_t elapsedNs  = 0;
+    for (std::size_t i = 0; i < intervals.size(); ++i) {
+        elapsedNs += intervals[i];
+        std::int64_t tickNs     = startNs + elapsedNs;
+        std::int64_t deadlineNs =
+            startNs + static_cast<std::int64_t>(i + 1) * targetNs;
+        // Only what this tick's own wait added: a tick whose deadline had
+        // already passed when the wait began inherits the earlier lateness
+        std::int64_t lateNs = tickNs - std::max(deadlineNs, previousNs);
+
+        // Gaps are in time order and do not overlap, so every gap that
+        // ended before this tick's wait began can be skipped for good
+        while (firstGap < gaps.size() &&
+               gaps[firstGap].startNs + gaps[firstGap].durationNs <=
+                   previousNs) {
+            ++firstGap;
+        }
+
+        if (lateNs > lateThreshold.count()) {
+            std::int64_t preemptedNs = 0;
+            std::int64_t otherNs     = 0;
+            for (std::size_t g = firstGap;
+                 g < gaps.size() && gaps[g].startNs < tickNs; ++g) {
+                std::int64_t overlap =
+                    std::min(gaps[g].startNs + gaps[g].durationNs, tickNs) -
+                    std::max(gaps[g].startNs, previousNs);
+                if (overlap > 0) {
+                    (gaps[g].detectorPreempted ? preemptedNs : otherNs) +=
+                        overlap;
+                }
+            }
+
+            std::int64_t noiseNs = preemptedNs + otherNs;
+            ++result.lateTicks;
+            result.latenessNs += lateNs;
+            if (noiseNs > 0) {
+                ++result.lateWithGap;
+                // Gap time beyond the lateness was absorbed by the spin
+                // margin, so only the lateness itself can be explained
+                double scale = static_cast<double>(std::min(noiseNs, lateNs)) /
+                               static_cast<double>(noiseNs);
+                result.detectorPreemptionNs +=
+                    static_cast<std::int64_t>(preemptedNs * scale);
+                result.otherNoiseNs +=
+                    static_cast<std::int64_t>(otherNs * scale);
+            }
+            if (lateNs > result.worstLateNs) {
+                result.worstLateNs  = lateNs;
+                result.worstNoiseNs = noiseNs;
+            }
+        }
+        previousNs = tickNs;
+    }
+    return result;
+}
+
+void printNoiseReport(const NoiseDetector& detector,
+                      const NoiseAttribution& attribution) {
+    auto us = [](std::int64_t ns) { return static_cast<double>(ns) / 1e3; };
+
+    std::size_t preemptedGaps = 0;
+    std::int64_t preemptedNs  = 0;
+    std::int64_t otherNs      = 0;
+    std::int64_t longestNs    = 0;
+    for (const NoiseGap& gap : detector.gaps()) {
+        if (gap.detectorPreempted) {
+            ++preemptedGaps;
+            preemptedNs += gap.durationNs;
+        } else {
+            otherNs += gap.durationNs;
+        }
+        longestNs = std::max(longestNs, gap.durationNs);
+    }
+    std::size_t otherGaps = detector.gaps().size() - preemptedGaps;
+    const NoiseDetectorOptions& options = detector.options();
+
+    logger << std::fixed << std::setprecision(2);
+    logger << "\n========== Host Noise (us) ==========\n"
+           << "Detector CPU: ";
+    if (options.cpu < 0) {
+        logger << "unpinned";
+    } else if (!detector.pinError().empty()) {
+        logger << "unpinned (CPU " << options.cpu
+               << " pinning failed: " << detector.pinError() << ")";
+    } else {
+        logger << options.cpu;
+    }
+    logger << "\n"
+           << "Detector clock reads: " << detector.samples() << " in "
+           << us(detector.runTime().count()) / 1e3 << " ms\n"
+           << "Gaps above " << us(options.threshold.count())
+           << " us: " << detector.gaps().size() << " (total "
+           << us(preemptedNs + otherNs) << ", longest " << us(longestNs)
+           << ")\n"
+           << "  Detector thread preempted: " << preemptedGaps << " gaps, "
+           << us(preemptedNs) << " total\n"
+           << "  Interrupt, SMI or hypervisor: " << otherGaps << " gaps, "
+           << us(otherNs) << " total\n";
+    if (detector.droppedGaps() > 0) {
+        logger << "  Not recorded (buffer full): " << detector.droppedGaps()
+               << " gaps\n";
+    }
+    logger << "Interrupts on the detector CPU: ";
+    if (detector.interrupts() >= 0) {
+        logger << detector.interrupts() << "\n";
+    } else {
+        logger << "unknown\n";
+    }
+    logger << "SMIs: ";
+    if (detector.smis() >= 0) {
+        logger << detector.smis() << "\n";
+    } else {
+        logger << "unknown (MSR_SMI_COUNT not readable)\n";
+    }
+
+    if (!attribution.available) {
+        logger << "Late tick attribution needs the raw intervals in memory "
+                  "(not available with --capture or an unbounded run)\n";
+    } else if (attribution.lateTicks == 0) {
+        logger << "Late ticks (> " << us(options.threshold.count())
+               << " us): none of " << attribution.ticks << "\n";
+    } else {
+        auto share = [&](std::int64_t ns) {
+            return 100.0 * static_cast<double>(ns) /
+                   static_cast<double>(attribution.latenessNs);
+        };
+        std::int64_t ownNs = attribution.latenessNs -
+                             attribution.detectorPreemptionNs -
+                             attribution.otherNoiseNs;
+        logger << "Late ticks (> " << us(options.threshold.count())
+               << " us): " << attribution.lateTicks << " of "
+               << attribution.ticks << ", " << attribution.lateWithGap
+               << " coinciding with a gap\n"
+               << "Lateness of late ticks: " << us(attribution.latenessNs)
+               << " total, by what the detector CPU saw meanwhile\n"
+               << "  Detector thread preempted: "
+               << share(attribution.detectorPreemptionNs) << "%\n"
+               << "  Interrupt, SMI or hypervisor: "
+               << share(attribution.otherNoiseNs) << "%\n"
+               << "  Timer itself (not covered by gaps): " << share(ownNs)
+               << "%\n"
+               << "Latest tick: " << us(attribution.worstLateNs)
+               << " late, " << us(attribution.worstNoiseNs)
+               << " of gaps during its wait\n";
+    }
+    logger << "=====================================\n";
+}
+
+}  // namespace ts
@@ -0,0 +1,348 @@
+#include "options.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "multi_core_engine.hpp"
+#include "sweep.hpp"
+#include "utils.hpp"
+
+namespace ts {
+
+namespace {
+
+int parseInt(const std::string& option, const char* arg, int minValue,
+             int maxValue) {
+    std::istringstream iss(arg);
+    int value;
+    iss >> value;
+
+    if (iss.fail() || !iss.eof() || value < minValue || value > maxValue) {
+        throw std::invalid_argument("Invalid value for " + option +
+                                    ": must be an integer between " +
+                                    std::to_string(minValue) + " and " +
+                                    std::to_string(maxValue));
+    }
+    return value;
+}
+
+std::size_t parseCount(const std::string& option, const char* arg) {
+    std::istringstream iss(arg);
+    unsigned long long value;
+    iss >> value;
+
+    if (iss.fail() || !iss.eof() || arg[0] == '-') {
+        throw std::invalid_argument("Invalid value for " + option +
+                                    ": must be a non-negative integer");
+    }
+    return static_cast<std::size_t>(value);
+}
+
+}  // anonymous namespace
+
+TimerKind parseTimerKind(const std::string& name) {
+    if (name == "auto") return TimerKind::Auto;
+    if (name == "timer") return TimerKind::Timer;
+    if (name == "highres") return TimerKind::HighRes;
+    throw std::invalid_argument("Invalid timer: " + name +
+                                " (expected auto, timer or highres)");
+}
+
+Options parseOptions(int argc, char* argv[]) {
+    if (argc < 2) {
+        throw std::invalid_argument("Missing interval");
+    }
+
+    // A sweep brings its own intervals, so the positional one is optional
+    Options options;
+    int first = 1;
+    if (std::string(argv[1]).rfind("--", 0) != 0) {
+        options.intervalSec = ::utils::parseInterval(argv[1]);
+        first               = 2;
+    }
+
+    bool iterationsGiven = false;
+    bool soakRolling     = false;
+    bool liveWindowGiven = false;
+    std::string soakList;
+    std::string sweepIterationList;
+
+    for (int i = first; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value      = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--timer") {
+            options.timerKind = parseTimerKind(value());
+        } else if (arg == "--clock") {
+            options.clockKind = parseClockSourceKind(value());
+        } else if (arg == "--spin-margin") {
+            options.spinMarginSec = ::utils::parseInterval(value());
+        } else if (arg == "--spin-policy") {
+            options.spinPolicy = parseSpinPolicy(value());
+        } else if (arg == "--overrun") {
+            options.overrunPolicy = parseOverrunPolicy(value());
+        } else if (arg == "--exclude-catch-up") {
+            options.excludeCatchUp = true;
+        } else if (arg == "--arena") {
+            options.arena.enabled = true;
+        } else if (arg == "--huge-pages") {
+            options.arena.enabled   = true;
+            options.arena.hugePages = parseHugePages(value());
+        } else if (arg == "--rt") {
+            options.realtime.enabled = true;
+        } else if (arg == "--rt-priority") {
+            options.realtime.enabled      = true;
+            options.realtime.fifoPriority = parseInt(arg, value(), 1, 99);
+        } else if (arg == "--timing-cpu") {
+            options.realtime.enabled   = true;
+            options.realtime.timingCpu = parseInt(arg, value(), 0, 4095);
+        } else if (arg == "--output-cpu") {
+            options.realtime.enabled   = true;
+            options.realtime.outputCpu = parseInt(arg, value(), 0, 4095);
+        } else if (arg == "--cores") {
+            options.cores = parseCpuList(value());
+        } else if (arg == "--capture") {
+            options.capturePath = value();
+        } else if (arg == "--trace") {
+            options.tracePath = value();
+        } else if (arg == "--async-log") {
+            options.asyncLog = true;
+        } else if (arg == "--wheel") {
+            options.wheelProbes = parseInt(arg, value(), 1, 1000000);
+        } else if (arg == "--coroutines") {
+            options.coroutineTickers = parseInt(arg, value(), 1, 1000000);
+        } else if (arg == "--noise") {
+            options.noiseCpu = parseInt(arg, value(), 0, 4095);
+        } else if (arg == "--noise-threshold") {
+            options.noiseThresholdSec = ::utils::parseInterval(value());
+        } else if (arg == "--live-stats") {
+            options.liveStatsName = value();
+        } else if (arg == "--live-window") {
+            options.liveWindowSec = ::utils::parseInterval(value());
+            liveWindowGiven       = true;
+        } else if (arg == "--stress") {
+            options.stressors.push_back(parseStressorSpec(value()));
+        } else if (arg == "--iterations") {
+            options.iterations = parseCount(arg, value());
+            iterationsGiven    = true;
+        } else if (arg == "--soak") {
+            soakList = value();
+        } else if (arg == "--soak-rolling") {
+            soakRolling = true;
+        } else if (arg == "--sweep") {
+            options.sweepIntervals = parseSweepIntervals(value());
+        } else if (arg == "--sweep-iterations") {
+            sweepIterationList = value();
+        } else if (arg == "--sweep-report") {
+            options.sweepReportPath = value();
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+
+    if (options.sweepIntervals.empty()) {
+        if (options.intervalSec <= 0) {
+            throw std::invalid_argument("Missing interval");
+        }
+        if (!sweepIterationList.empty() || !options.sweepReportPath.empty()) {
+            throw std::invalid_argument(
+                "--sweep-iterations and --sweep-report need --sweep");
+        }
+    } else {
+        if (options.intervalSec > 0) {
+            throw std::invalid_argument(
+                "--sweep replaces the <seconds> argument");
+        }
+        if (!options.cores.empty() || !soakList.empty() ||
+            !options.capturePath.empty() || !options.tracePath.empty() ||
+            options.wheelProbes > 0 || options.coroutineTickers > 0 ||
+            options.noiseCpu >= 0 || !options.liveStatsName.empty() ||
+            !options.stressors.empty()) {
+            throw std::invalid_argument(
+                "--sweep cannot be combined with --cores, --soak, "
+                "--capture, --trace, --wheel, --coroutines, --noise, "
+                "--live-stats or --stress");
+        }
+        if (!sweepIterationList.empty()) {
+            options.sweepIterations = parseSweepIterations(sweepIterationList);
+        } else if (options.iterations > 0) {
+            options.sweepIterations = {options.iterations};
+        } else {
+            throw std::invalid_argument(
+                "--sweep needs a bounded number of --iterations");
+        }
+    }
+
+    if (soakRolling && soakList.empty()) {
+        throw std::invalid_argument("--soak-rolling needs --soak");
+    }
+    if (!soakList.empty()) {
+        options.soakWindows = parseSoakWindows(soakList, soakRolling);
+        if (!iterationsGiven) {
+            options.iterations = 0;
+        }
+    }
+    if (!options.stressors.empty()) {
+        if (!options.cores.empty() || !soakList.empty() ||
+            !options.capturePath.empty() || !options.tracePath.empty() ||
+            options.wheelProbes > 0 || options.coroutineTickers > 0 ||
+            options.noiseCpu >= 0) {
+            throw std::invalid_argument(
+                "--stress cannot be combined with --cores, --soak, "
+                "--capture, --trace, --wheel, --coroutines or --noise");
+        }
+        if (options.iterations == 0) {
+            throw std::invalid_argument(
+                "--stress needs a bounded number of --iterations");
+        }
+    }
+    if (options.excludeCatchUp &&
+        options.overrunPolicy != OverrunPolicy::CatchUp) {
+        throw std::invalid_argument(
+            "--exclude-catch-up needs the catch-up overrun policy");
+    }
+    if (liveWindowGiven && options.liveStatsName.empty()) {
+        throw std::invalid_argument("--live-window needs --live-stats");
+    }
+    if (!options.liveStatsName.empty() && !iterationsGiven &&
+        options.cores.empty()) {
+        // Watched from timer-top, so it runs until stopped like a soak
+        options.iterations = 0;
+    }
+    // Noise attribution rebuilds every tick's deadline on the catch-up
+    // grid, and capture readers rebuild timestamps by summing intervals;
+    // a moved grid or a missing tick would skew every later one
+    if (options.noiseCpu >= 0 &&
+        (options.overrunPolicy != OverrunPolicy::CatchUp ||
+         options.excludeCatchUp)) {
+        throw std::invalid_argument(
+            "--noise needs the catch-up overrun policy without "
+            "--exclude-catch-up");
+    }
+    if (!options.capturePath.empty() && options.excludeCatchUp) {
+        throw std::invalid_argument(
+            "--capture cannot be combined with --exclude-catch-up");
+    }
+    if (options.noiseCpu >= 0 &&
+        options.noiseCpu == options.realtime.timingCpu) {
+        throw std::invalid_argument(
+            "--noise needs a CPU other than the --timing-cpu");
+    }
+    if (options.iterations == 0 && !options.cores.empty()) {
+        throw std::invalid_argument(
+            "--cores needs a bounded number of --iterations");
+    }
+    // Every core's soak windows would go to the same log, unlabeled
+    if (!soakList.empty() && !options.cores.empty()) {
+        throw std::invalid_argument("--soak cannot be combined with --cores");
+    }
+    if (options.iterations == 0 &&
+        (options.wheelProbes > 0 || options.coroutineTickers > 0)) {
+        throw std::invalid_argument(
+            "--wheel and --coroutines need a bounded number of --iterations");
+    }
+    return options;
+}
+
+void printUsage(const char* programName) {
+    std::cerr
+        << "Usage: " << programName << " <seconds> [options]\n"
+        << "       " << programName << " --sweep <intervals> [options]\n"
+        << "  seconds: Target interval duration in seconds (positive number, "
+           "supports sub-millisecond)\n"
+        << "Options:\n"
+        << "  --timer <auto|timer|highres>\n"
+        << "                             Timer to run (default: auto, "
+           "highres below 2ms)\n"
+        << "  --clock <auto|steady|tsc>  Clock read by HighResTimer "
+           "(default: auto)\n"
+        << "  --spin-margin <seconds>    Fixed Timer spin margin instead of "
+           "the adaptive one\n"
+        << "  --spin-policy <auto|raw|pause|tpause|yield>\n"
+        << "                             Relaxation between spin polls "
+           "(default: auto)\n"
+        << "  --overrun <catch-up|skip|reanchor>\n"
+        << "                             After a tick late by a period or "
+           "more: fire the missed\n"
+        << "                             deadlines at once, wait for the next "
+           "slot, or restart the\n"
+        << "                             grid (default: catch-up)\n"
+        << "  --exclude-catch-up         Report catch-up ticks apart from the "
+           "statistics\n"
+        << "  --arena                    Prefault and lock the run's sample, "
+           "output and trace\n"
+        << "                             buffers before the timing loop\n"
+        << "  --huge-pages <none|thp|hugetlb>\n"
+        << "                             Back the arena with huge pages "
+           "(implies --arena)\n"
+        << "  --rt                       Linux real-time mode: absolute "
+           "clock_nanosleep, mlockall\n"
+        << "  --rt-priority <1-99>       Run the timing thread as SCHED_FIFO "
+           "(implies --rt)\n"
+        << "  --timing-cpu <cpu>         Pin the timing thread (implies --rt)\n"
+        << "  --output-cpu <cpu>         Pin the output thread (implies --rt)\n"
+        << "  --cores <list|all>         Run one timer per CPU concurrently, "
+           "e.g. 0,2-5\n"
+        << "  --capture <file>           Write raw intervals to a binary "
+           "capture file\n"
+        << "  --trace <file>             Write a per-tick phase trace as "
+           "Chrome trace JSON\n"
+        << "                             (needs -DTIMESTAMP_ENABLE_TRACE=ON)\n"
+        << "  --async-log                Format log records off the timing "
+           "thread\n"
+        << "  --wheel <count>            Drive count periodic probes from one "
+           "timing wheel thread\n"
+        << "  --coroutines <count>       Run count coroutine tickers on one "
+           "executor thread\n"
+        << "                             (needs "
+           "-DTIMESTAMP_ENABLE_COROUTINES=ON)\n"
+        << "  --noise <cpu>              Detect host noise on an idle CPU "
+           "and attribute late ticks\n"
+        << "  --noise-threshold <seconds>\n"
+        << "                             Smallest noise gap and tick "
+           "lateness counted (default: 10e-6)\n"
+        << "  --live-stats <name>        Publish running statistics to a "
+           "shared-memory segment\n"
+        << "                             for timer-top; no per-tick output, "
+           "runs until Ctrl-C\n"
+        << "                             by default\n"
+        << "  --live-window <seconds>    Rolling percentile window of "
+           "--live-stats (default: 1)\n"
+        << "  --stress <kind[:threads][@cpus]>\n"
+        << "                             Compare tick lateness unloaded and "
+           "next to stressor\n"
+        << "                             threads: spin, memory, cache, "
+           "syscall or alloc, pinned\n"
+        << "                             to a CPU list or @sibling of "
+           "--timing-cpu (repeatable)\n"
+        << "  --iterations <count>       Intervals to measure (default: 100, "
+           "0 runs until Ctrl-C)\n"
+        << "  --soak <windows>           Log statistics per window while "
+           "running, e.g. 1s,1m,1h;\n"
+        << "                             no per-tick output, runs until "
+           "Ctrl-C by default\n"
+        << "  --soak-rolling             Make the --soak windows rolling "
+           "instead of tumbling\n"
+        << "  --sweep <intervals>        Run each interval in turn in one "
+           "process: a list such as\n"
+        << "                             0.0001,0.001 or start:stop:count, "
+           "log-spaced\n"
+        << "  --sweep-iterations <list>  Iteration counts run at every sweep "
+           "interval\n"
+        << "                             (default: --iterations)\n"
+        << "  --sweep-report <file>      Write the sweep table as CSV, or JSON "
+           "for a .json file\n"
+        << "Example: " << programName << " 0.001  # 1ms interval\n"
+        << "         " << programName << " 0.0001 # 100us interval\n"
+        << "         " << programName
+        << " --sweep 50e-6:1:10  # 50us to 1s, 10 log-spaced steps\n";
+}
+
+}  // namespace ts
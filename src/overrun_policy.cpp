@@ -0,0 +1,27 @@
+#include "overrun_policy.hpp"
+
+#include <stdexcept>
+
+namespace ts {
+
+OverrunPolicy parseOverrunPolicy(const std::string& name) {
+    if (name == "catch-up") return OverrunPolicy::CatchUp;
+    if (name == "skip") return OverrunPolicy::Skip;
+    if (name == "reanchor") return OverrunPolicy::Reanchor;
+    throw std::invalid_argument("Invalid overrun policy: " + name +
+                                " (expected catch-up, skip or reanchor)");
+}
+
+const char* overrunPolicyName(OverrunPolicy policy) {
+    switch (policy) {
+    case OverrunPolicy::CatchUp:
+        return "catch-up";
+    case OverrunPolicy::Skip:
+        return "skip";
+    case OverrunPolicy::Reanchor:
+        return "reanchor";
+    }
+    return "unknown";
+}
+
+}  // namespace ts
@@ -0,0 +1,194 @@
+#include "periodic_executor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+
+#include <mmsystem.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+ExecutorStrategy resolveStrategy(ExecutorStrategy strategy,
+                                 std::chrono::nanoseconds period) {
+    if (strategy != ExecutorStrategy::Auto) {
+        return strategy;
+    }
+    return std::chrono::duration<double>(period).count() < kHighResThresholdSec
+               ? ExecutorStrategy::BusySpin
+               : ExecutorStrategy::SleepSpin;
+}
+
+void storeMax(std::atomic<std::int64_t>& target, std::int64_t value) {
+    // Single writer, so a plain load/compare/store is enough
+    if (value > target.load(std::memory_order_relaxed)) {
+        target.store(value, std::memory_order_relaxed);
+    }
+}
+
+}  // anonymous namespace
+
+PeriodicExecutor::PeriodicExecutor(std::chrono::nanoseconds period,
+                                   Callback callback,
+                                   const ExecutorOptions& options)
+    : period_(period),
+      callback_(std::move(callback)),
+      strategy_(resolveStrategy(options.strategy, period)),
+      realtime_(options.realtime),
+      clock_(strategy_ == ExecutorStrategy::BusySpin
+                 ? options.clockKind
+                 : ClockSourceKind::Steady),
+      sleepWait_(period),
+      busyWait_(period) {
+    if (period_.count() <= 0) {
+        throw std::invalid_argument("Executor period must be positive");
+    }
+    if (!callback_) {
+        throw std::invalid_argument("Executor callback must not be empty");
+    }
+    sleepWait_.setSpinPolicy(options.spinPolicy);
+    busyWait_.setSpinPolicy(options.spinPolicy);
+    if (options.spinMargin.count() > 0) {
+        sleepWait_.setFixedMargin(options.spinMargin);
+    }
+}
+
+PeriodicExecutor::~PeriodicExecutor() {
+    stopRequested_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void PeriodicExecutor::start() {
+    if (running()) {
+        throw std::logic_error("Executor is already running");
+    }
+    // A previous run may have ended on its own after a callback exception
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+
+    error_ = nullptr;
+    lateness_.reset();
+    realtimeReport_ = RealtimeReport{};
+    ticks_.store(0, std::memory_order_relaxed);
+    overruns_.store(0, std::memory_order_relaxed);
+    skippedTicks_.store(0, std::memory_order_relaxed);
+    longestCallbackNs_.store(0, std::memory_order_relaxed);
+    maxLatenessNs_.store(0, std::memory_order_relaxed);
+    stopRequested_.store(false, std::memory_order_relaxed);
+
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&PeriodicExecutor::loop, this);
+}
+
+void PeriodicExecutor::stop() {
+    stopRequested_.store(true, std::memory_order_relaxed);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_                   = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+ExecutorStats PeriodicExecutor::stats() const {
+    return {ticks_.load(std::memory_order_relaxed),
+            overruns_.load(std::memory_order_relaxed),
+            skippedTicks_.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds(
+                longestCallbackNs_.load(std::memory_order_relaxed)),
+            std::chrono::nanoseconds(
+                maxLatenessNs_.load(std::memory_order_relaxed))};
+}
+
+void PeriodicExecutor::waitUntil(
+    std::chrono::steady_clock::time_point deadline) {
+    if (strategy_ == ExecutorStrategy::BusySpin) {
+        busyWait_.waitUntil(clock_, {}, deadline, false);
+        return;
+    }
+    // The sleep starts now, after the callback, not at the last wake-up
+    sleepWait_.waitUntil(clock_, clock_.now(), deadline, realtime_.enabled);
+}
+
+void PeriodicExecutor::loop() {
+#ifdef _WIN32
+    timeBeginPeriod(1);
+#endif
+    try {
+        RealtimeGuard realtimeGuard(realtime_, realtimeReport_,
+                                    strategy_ != ExecutorStrategy::BusySpin);
+        if (strategy_ == ExecutorStrategy::BusySpin) {
+            busyWait_.begin(clock_);
+        } else {
+            sleepWait_.begin(clock_);
+        }
+
+        std::uint64_t index = 0;
+        auto deadline       = clock_.now() + period_;
+
+        while (!stopRequested_.load(std::memory_order_relaxed)) {
+            waitUntil(deadline);
+            if (stopRequested_.load(std::memory_order_relaxed)) {
+                break;
+            }
+
+            auto callbackStart = clock_.now();
+            auto lateness      = std::chrono::duration_cast<
+                std::chrono::nanoseconds>(callbackStart - deadline);
+            callback_(TickInfo{index, deadline, lateness});
+            auto callbackEnd = clock_.now();
+
+            std::int64_t latenessNs = std::max<std::int64_t>(
+                lateness.count(), 0);
+            lateness_.record(static_cast<std::uint64_t>(latenessNs));
+            storeMax(maxLatenessNs_, latenessNs);
+            storeMax(longestCallbackNs_,
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         callbackEnd - callbackStart)
+                         .count());
+            ticks_.fetch_add(1, std::memory_order_relaxed);
+            clock_.resyncIfDue(callbackEnd);
+
+            // Skip every deadline the callback ran past instead of firing
+            // them back to back
+            deadline += period_;
+            ++index;
+            if (callbackEnd > deadline) {
+                std::uint64_t missed =
+                    static_cast<std::uint64_t>((callbackEnd - deadline) /
+                                               period_) +
+                    1;
+                deadline += period_ * static_cast<std::int64_t>(missed);
+                index += missed;
+                overruns_.fetch_add(1, std::memory_order_relaxed);
+                skippedTicks_.fetch_add(missed, std::memory_order_relaxed);
+            }
+        }
+        sleepWait_.end();
+        busyWait_.end();
+    } catch (...) {
+        error_ = std::current_exception();
+    }
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+    running_.store(false, std::memory_order_release);
+}
+
+}  // namespace ts
@@ -0,0 +1,207 @@
+#include "quantile_select.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace ts {
+
+namespace {
+
+constexpr int kBucketBits      = 16;
+constexpr std::size_t kBuckets = std::size_t(1) << kBucketBits;
+
+// Distinct ranges per counting pass, one per percentile at most
+constexpr std::size_t kMaxRanges = 16;
+
+std::uint64_t rankOf(double fraction, std::size_t count) {
+    std::uint64_t rank = static_cast<std::uint64_t>(
+        std::clamp(fraction, 0.0, 1.0) * static_cast<double>(count));
+    return rank >= count ? count - 1 : rank;
+}
+
+// Run work(thread, begin, end) on contiguous chunks of [0, count), one per
+// thread, the first on the calling thread
+template <typename Work>
+void forEachChunk(unsigned int threads, std::size_t count, const Work& work) {
+    std::size_t chunk = (count + threads - 1) / threads;
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned int t = 1; t < threads; ++t) {
+        std::size_t begin = std::min(count, t * chunk);
+        std::size_t end   = std::min(count, begin + chunk);
+        workers.emplace_back(work, t, begin, end);
+    }
+    work(0u, std::size_t(0), std::min(count, chunk));
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+}  // anonymous namespace
+
+QuantileSelector::QuantileSelector(unsigned int threads)
+    : threads_(threads != 0
+                   ? threads
+                   : std::max(1u, std::thread::hardware_concurrency())) {}
+
+void QuantileSelector::select(const std::int64_t* data, std::size_t count,
+                              const double* fractions,
+                              std::size_t fractionCount, std::int64_t* out) {
+    if (count == 0) {
+        throw std::invalid_argument("No samples to select percentiles from");
+    }
+
+    targets_.clear();
+    for (std::size_t i = 0; i < fractionCount; ++i) {
+        targets_.push_back({i, rankOf(fractions[i], count), 0, false});
+    }
+    std::sort(targets_.begin(), targets_.end(),
+              [](const Target& a, const Target& b) { return a.rank < b.rank; });
+
+    if (threads_ > 1 && count >= kParallelThreshold &&
+        fractionCount <= kMaxRanges) {
+        selectParallel(data, count, out);
+    } else {
+        selectSequential(data, count, out);
+    }
+}
+
+std::int64_t QuantileSelector::select(const std::vector<std::int64_t>& data,
+                                      double fraction) {
+    std::int64_t value = 0;
+    select(data.data(), data.size(), &fraction, 1, &value);
+    return value;
+}
+
+void QuantileSelector::selectSequential(const std::int64_t* data,
+                                        std::size_t count,
+                                        std::int64_t* out) {
+    scratch_.assign(data, data + count);
+
+    // Everything left of the previous rank is no larger than it, so each
+    // selection only has to partition what lies to its right
+    auto first = scratch_.begin();
+    for (const Target& target : targets_) {
+        auto nth = scratch_.begin() + static_cast<std::ptrdiff_t>(target.rank);
+        std::nth_element(first, nth, scratch_.end());
+        out[target.fraction] = *nth;
+        first                = nth;
+    }
+}
+
+void QuantileSelector::selectParallel(const std::int64_t* data,
+                                      std::size_t count, std::int64_t* out) {
+    const unsigned int threads = threads_;
+
+    std::vector<std::int64_t> lows(threads,
+                                   std::numeric_limits<std::int64_t>::max());
+    std::vector<std::int64_t> highs(threads,
+                                    std::numeric_limits<std::int64_t>::min());
+    forEachChunk(threads, count,
+                 [&](unsigned int t, std::size_t begin, std::size_t end) {
+                     if (begin < end) {
+                         auto minMax = std::minmax_element(data + begin,
+                                                           data + end);
+                         lows[t]  = *minMax.first;
+                         highs[t] = *minMax.second;
+                     }
+                 });
+    std::int64_t low  = *std::min_element(lows.begin(), lows.end());
+    std::int64_t high = *std::max_element(highs.begin(), highs.end());
+
+    // Offsets are taken in unsigned arithmetic, so values below a range wrap
+    // around to large offsets and fall outside it as well
+    std::uint64_t span = static_cast<std::uint64_t>(high) -
+                         static_cast<std::uint64_t>(low);
+    int shift = 0;
+    while ((span >> shift) >= kBuckets) {
+        ++shift;
+    }
+    ranges_.assign(1, Range{low, shift});
+
+    std::size_t pending = targets_.size();
+    while (pending > 0) {
+        const std::size_t rangeCount = ranges_.size();
+        const std::size_t perThread  = rangeCount * kBuckets;
+        counts_.resize(perThread * threads);
+
+        // A range narrowed from a bucket narrower than 2^16 reaches past
+        // it and may overlap its neighbour's; the extra values lie above
+        // every rank in it, so they only cost a count
+        forEachChunk(
+            threads, count,
+            [&](unsigned int t, std::size_t begin, std::size_t end) {
+                std::uint64_t* counts = counts_.data() + t * perThread;
+                std::fill(counts, counts + perThread, 0);
+
+                // Local copies, which the count stores cannot alias
+                std::uint64_t lows[kMaxRanges];
+                int shifts[kMaxRanges];
+                for (std::size_t r = 0; r < rangeCount; ++r) {
+                    lows[r]   = static_cast<std::uint64_t>(ranges_[r].low);
+                    shifts[r] = ranges_[r].shift;
+                }
+
+                for (std::size_t i = begin; i < end; ++i) {
+                    std::uint64_t value = static_cast<std::uint64_t>(data[i]);
+                    for (std::size_t r = 0; r < rangeCount; ++r) {
+                        std::uint64_t bucket = (value - lows[r]) >> shifts[r];
+                        if (bucket < kBuckets) {
+                            ++counts[r * kBuckets + bucket];
+                        }
+                    }
+                }
+            });
+
+        // Find the bucket holding each pending rank and narrow the rank to
+        // that bucket; a bucket of width one is the answer
+        nextRanges_.clear();
+        for (Target& target : targets_) {
+            if (target.resolved) {
+                continue;
+            }
+            const Range range          = ranges_[target.range];
+            const std::uint64_t* total = counts_.data() +
+                                         target.range * kBuckets;
+            std::uint64_t below  = 0;
+            std::uint64_t bucket = 0;
+            for (; bucket < kBuckets; ++bucket) {
+                std::uint64_t inBucket = 0;
+                for (unsigned int t = 0; t < threads; ++t) {
+                    inBucket += total[t * perThread + bucket];
+                }
+                if (below + inBucket > target.rank) {
+                    break;
+                }
+                below += inBucket;
+            }
+
+            std::int64_t bucketLow = static_cast<std::int64_t>(
+                static_cast<std::uint64_t>(range.low) +
+                (bucket << range.shift));
+            if (range.shift == 0) {
+                out[target.fraction] = bucketLow;
+                target.resolved      = true;
+                --pending;
+                continue;
+            }
+
+            Range next{bucketLow, std::max(range.shift - kBucketBits, 0)};
+            auto found = std::find_if(
+                nextRanges_.begin(), nextRanges_.end(), [&](const Range& r) {
+                    return r.low == next.low && r.shift == next.shift;
+                });
+            target.rank -= below;
+            target.range = static_cast<std::size_t>(found -
+                                                    nextRanges_.begin());
+            if (found == nextRanges_.end()) {
+                nextRanges_.push_back(next);
+            }
+        }
+        ranges_.swap(nextRanges_);
+    }
+}
+
+}  // namespace ts
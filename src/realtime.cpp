@@ -0,0 +1,214 @@
+#include "realtime.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <time.h>
+#endif
+
+namespace ts {
+
+#ifdef __linux__
+
+namespace {
+
+void sleepUntilNs(clockid_t clock, long long deadlineNs) {
+    timespec deadline{};
+    deadline.tv_sec  = static_cast<time_t>(deadlineNs / 1000000000LL);
+    deadline.tv_nsec = static_cast<long>(deadlineNs % 1000000000LL);
+    // clock_nanosleep returns the error number instead of setting errno
+    while (clock_nanosleep(clock, TIMER_ABSTIME, &deadline, nullptr) ==
+           EINTR) {
+    }
+}
+
+std::string errorText(int err) {
+    return std::strerror(err);
+}
+
+// mlockall is process-wide, so guards running at the same time (one per
+// core with --cores) share one lock, taken by the first and released by
+// the last
+std::mutex memoryLockMutex;
+int memoryLockUsers = 0;
+
+bool lockProcessMemory() {
+    std::lock_guard<std::mutex> lock(memoryLockMutex);
+    if (memoryLockUsers == 0 && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        return false;
+    }
+    ++memoryLockUsers;
+    return true;
+}
+
+void unlockProcessMemory() {
+    std::lock_guard<std::mutex> lock(memoryLockMutex);
+    if (--memoryLockUsers == 0) {
+        munlockall();
+    }
+}
+
+}  // anonymous namespace
+
+struct RealtimeGuard::SavedState {
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    bool policyChanged = false;
+    cpu_set_t affinity{};
+    bool affinityChanged = false;
+    int timerSlack       = -1;
+    bool memoryLocked    = false;
+};
+
+RealtimeGuard::RealtimeGuard(const RealtimeOptions& options,
+                             RealtimeReport& report, bool sleeps)
+    : saved_(std::make_unique<SavedState>()) {
+    report = RealtimeReport{};
+    if (!options.enabled) {
+        return;
+    }
+
+    pthread_t self = pthread_self();
+    if (sleeps) {
+        report.applied.push_back("clock_nanosleep(TIMER_ABSTIME) deadlines");
+    }
+
+    int slack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    if (slack >= 0 && prctl(PR_SET_TIMERSLACK, 1, 0, 0, 0) == 0) {
+        saved_->timerSlack = slack;
+        report.applied.push_back("timer slack 1ns");
+    } else {
+        report.skipped.push_back("timer slack: " + errorText(errno));
+    }
+
+    if (lockProcessMemory()) {
+        saved_->memoryLocked = true;
+        report.applied.push_back("mlockall");
+    } else {
+        report.skipped.push_back("mlockall: " + errorText(errno));
+    }
+
+    if (options.timingCpu >= 0) {
+        std::string error;
+        int err = pthread_getaffinity_np(self, sizeof(cpu_set_t),
+                                         &saved_->affinity);
+        if (err != 0) {
+            error = errorText(err);
+        } else if (pinCurrentThread(options.timingCpu, error)) {
+            saved_->affinityChanged = true;
+            report.applied.push_back("timing thread pinned to CPU " +
+                                     std::to_string(options.timingCpu));
+        }
+        if (!saved_->affinityChanged) {
+            report.skipped.push_back("timing thread CPU pinning: " + error);
+        }
+    }
+
+    if (options.fifoPriority > 0) {
+        pthread_getschedparam(self, &saved_->policy, &saved_->param);
+        sched_param param{};
+        param.sched_priority = options.fifoPriority;
+        int err              = pthread_setschedparam(self, SCHED_FIFO, &param);
+        if (err == 0) {
+            saved_->policyChanged = true;
+            report.applied.push_back("SCHED_FIFO priority " +
+                                     std::to_string(options.fifoPriority));
+        } else {
+            report.skipped.push_back("SCHED_FIFO: " + errorText(err));
+        }
+    }
+
+    for (const std::string& skipped : report.skipped) {
+        std::cerr << "Warning: real-time setting not applied, " << skipped
+                  << "\n";
+    }
+}
+
+RealtimeGuard::~RealtimeGuard() {
+    pthread_t self = pthread_self();
+    if (saved_->policyChanged) {
+        pthread_setschedparam(self, saved_->policy, &saved_->param);
+    }
+    if (saved_->affinityChanged) {
+        pthread_setaffinity_np(self, sizeof(cpu_set_t), &saved_->affinity);
+    }
+    if (saved_->timerSlack >= 0) {
+        prctl(PR_SET_TIMERSLACK, saved_->timerSlack, 0, 0, 0);
+    }
+    if (saved_->memoryLocked) {
+        unlockProcessMemory();
+    }
+}
+
+bool pinCurrentThread(int cpu, std::string& error) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        error = "invalid CPU " + std::to_string(cpu);
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0) {
+        error = "CPU " + std::to_string(cpu) + ": " + errorText(err);
+        return false;
+    }
+    return true;
+}
+
+void sleepUntilAbsolute(std::chrono::system_clock::time_point deadline) {
+    sleepUntilNs(CLOCK_REALTIME,
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     deadline.time_since_epoch())
+                     .count());
+}
+
+void sleepUntilAbsolute(std::chrono::steady_clock::time_point deadline) {
+    // libstdc++ and libc++ both implement steady_clock on CLOCK_MONOTONIC
+    sleepUntilNs(CLOCK_MONOTONIC,
+                 std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     deadline.time_since_epoch())
+                     .count());
+}
+
+#else
+
+struct RealtimeGuard::SavedState {};
+
+RealtimeGuard::RealtimeGuard(const RealtimeOptions& options,
+                             RealtimeReport& report, bool)
+    : saved_(std::make_unique<SavedState>()) {
+    report = RealtimeReport{};
+    if (options.enabled) {
+        report.skipped.push_back("real-time mode: only supported on Linux");
+        std::cerr << "Warning: real-time mode is only supported on Linux\n";
+    }
+}
+
+RealtimeGuard::~RealtimeGuard() = default;
+
+bool pinCurrentThread(int cpu, std::string& error) {
+    error = "CPU " + std::to_string(cpu) +
+            ": thread pinning is only supported on Linux";
+    return false;
+}
+
+void sleepUntilAbsolute(std::chrono::system_clock::time_point deadline) {
+    std::this_thread::sleep_until(deadline);
+}
+
+void sleepUntilAbsolute(std::chrono::steady_clock::time_point deadline) {
+    std::this_thread::sleep_until(deadline);
+}
+
+#endif
+
+}  // namespace ts
@@ -0,0 +1,235 @@
+#include "run_arena.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+// Size of a transparent or default explicit huge page on x86-64 and arm64
+constexpr std::size_t kHugePageBytes = 2 * 1024 * 1024;
+
+std::size_t roundUp(std::size_t bytes, std::size_t granule) {
+    return (bytes + granule - 1) / granule * granule;
+}
+
+std::size_t pageBytes() {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    long size = ::sysconf(_SC_PAGESIZE);
+    return size > 0 ? static_cast<std::size_t>(size) : 4096;
+#endif
+}
+
+}  // anonymous namespace
+
+HugePages parseHugePages(const std::string& text) {
+    if (text == "none") {
+        return HugePages::None;
+    }
+    if (text == "thp") {
+        return HugePages::Transparent;
+    }
+    if (text == "hugetlb") {
+        return HugePages::Explicit;
+    }
+    throw std::invalid_argument("Invalid huge pages: " + text +
+                                " (expected none, thp or hugetlb)");
+}
+
+const char* hugePagesName(HugePages pages) {
+    switch (pages) {
+    case HugePages::None:
+        return "none";
+    case HugePages::Transparent:
+        return "thp";
+    case HugePages::Explicit:
+        return "hugetlb";
+    }
+    return "unknown";
+}
+
+PageFaults threadPageFaults() {
+    PageFaults faults;
+#if defined(RUSAGE_THREAD)
+    struct rusage usage {};
+    if (::getrusage(RUSAGE_THREAD, &usage) == 0) {
+        faults.available = true;
+        faults.minor     = static_cast<std::uint64_t>(usage.ru_minflt);
+        faults.major     = static_cast<std::uint64_t>(usage.ru_majflt);
+    }
+#endif
+    return faults;
+}
+
+RunArena::RunArena(std::size_t bytes, HugePages hugePages)
+    : capacity_(roundUp(bytes == 0 ? 1 : bytes, pageBytes())),
+      hugePages_(hugePages) {
+#ifdef _WIN32
+    if (hugePages_ != HugePages::None) {
+        warnings_.push_back(std::string(hugePagesName(hugePages_)) +
+                            " huge pages are not supported on Windows");
+        hugePages_ = HugePages::None;
+    }
+    void* mapping = ::VirtualAlloc(nullptr, capacity_,
+                                   MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (mapping == nullptr) {
+        throw std::bad_alloc();
+    }
+    base_   = static_cast<unsigned char*>(mapping);
+    mapped_ = capacity_;
+    prefault();
+    lock();
+#else
+#ifdef MAP_HUGETLB
+    if (hugePages_ == HugePages::Explicit) {
+        std::size_t length = roundUp(capacity_, kHugePageBytes);
+        void* mapping =
+            ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mapping != MAP_FAILED) {
+            base_     = static_cast<unsigned char*>(mapping);
+            mapped_   = length;
+            capacity_ = length;
+        } else {
+            warnings_.push_back(std::string("hugetlb: ") +
+                                std::strerror(errno) +
+                                ", using transparent huge pages");
+            hugePages_ = HugePages::Transparent;
+        }
+    }
+#else
+    if (hugePages_ == HugePages::Explicit) {
+        warnings_.push_back("hugetlb is not supported on this platform, "
+                            "using transparent huge pages");
+        hugePages_ = HugePages::Transparent;
+    }
+#endif
+
+    if (base_ == nullptr) {
+        // Transparent huge pages only back aligned 2 MiB extents, so the
+        // mapping is over-allocated and trimmed to a huge page boundary
+        const bool thp   = hugePages_ == HugePages::Transparent;
+        std::size_t size = thp ? roundUp(capacity_, kHugePageBytes)
+                               : capacity_;
+        std::size_t length = thp ? size + kHugePageBytes : size;
+        void* mapping      = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto* start = static_cast<unsigned char*>(mapping);
+        if (thp) {
+            auto address = reinterpret_cast<std::uintptr_t>(start);
+            auto* aligned =
+                reinterpret_cast<unsigned char*>(roundUp(address,
+                                                         kHugePageBytes));
+            std::size_t head = static_cast<std::size_t>(aligned - start);
+            if (head > 0) {
+                ::munmap(start, head);
+            }
+            if (length - head > size) {
+                ::munmap(aligned + size, length - head - size);
+            }
+            start  = aligned;
+            length = size;
+        }
+        base_     = start;
+        mapped_   = length;
+        capacity_ = size;
+
+#ifdef MADV_HUGEPAGE
+        if (thp && ::madvise(base_, mapped_, MADV_HUGEPAGE) != 0) {
+            warnings_.push_back(std::string("madvise(MADV_HUGEPAGE): ") +
+                                std::strerror(errno));
+            hugePages_ = HugePages::None;
+        }
+#else
+        if (thp) {
+            warnings_.push_back(
+                "transparent huge pages are not supported on this platform");
+            hugePages_ = HugePages::None;
+        }
+#endif
+    }
+
+    prefault();
+    lock();
+#endif
+}
+
+RunArena::~RunArena() {
+    if (base_ == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    if (locked_) {
+        ::VirtualUnlock(base_, mapped_);
+    }
+    ::VirtualFree(base_, 0, MEM_RELEASE);
+#else
+    // munmap drops the lock along with the pages
+    ::munmap(base_, mapped_);
+#endif
+}
+
+void RunArena::reset() {
+    used_ = 0;
+    lock();
+}
+
+void RunArena::lock() {
+#ifdef _WIN32
+    // Fails once the block outgrows the minimum working set
+    locked_    = ::VirtualLock(base_, mapped_) != 0;
+    lockError_ = locked_ ? std::string()
+                         : "VirtualLock failed (error " +
+                               std::to_string(::GetLastError()) + ")";
+#else
+    locked_    = ::mlock(base_, mapped_) == 0;
+    lockError_ = locked_ ? std::string()
+                         : std::string("mlock: ") + std::strerror(errno);
+#endif
+}
+
+void RunArena::prefault() {
+    // A store, not a load: reading an untouched anonymous page only maps
+    // the shared zero page, and the first store would still fault
+    const std::size_t step = pageBytes();
+    for (std::size_t offset = 0; offset < mapped_; offset += step) {
+        static_cast<volatile unsigned char*>(base_)[offset] = 0;
+    }
+}
+
+void* RunArena::allocate(std::size_t bytes) {
+    std::size_t size = footprint(bytes == 0 ? 1 : bytes);
+    if (size > capacity_ - used_) {
+        throw std::bad_alloc();
+    }
+    void* p = base_ + used_;
+    used_ += size;
+    return p;
+}
+
+}  // namespace ts
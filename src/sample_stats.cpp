@@ -0,0 +1,223 @@
+#include "sample_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TS_HAVE_SSE2_STATS 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define TS_HAVE_AVX2_STATS 1
+#include <immintrin.h>
+#endif
+#endif
+
+namespace ts {
+
+namespace {
+
+struct Accumulator {
+    double sum;         // of sample - target
+    double sumSquares;  // of (sample - target)^2
+    double sumAbs;      // of |sample - target|
+    double min;
+    double max;
+    double maxJitter;
+};
+
+// Samples below 2^52 are exact as doubles
+constexpr double kTwoPow52 = 4503599627370496.0;
+
+void accumulateScalar(const std::int64_t* samples, std::size_t begin,
+                      std::size_t end, double target, Accumulator& acc) {
+    for (std::size_t i = begin; i < end; ++i) {
+        double value     = static_cast<double>(samples[i]);
+        double deviation = value - target;
+        acc.sum += deviation;
+        acc.sumSquares += deviation * deviation;
+        acc.sumAbs += std::fabs(deviation);
+        acc.min = std::min(acc.min, value);
+        acc.max = std::max(acc.max, value);
+        if (i > 0) {
+            double jitter = std::fabs(
+                value - static_cast<double>(samples[i - 1]));
+            acc.maxJitter = std::max(acc.maxJitter, jitter);
+        }
+    }
+}
+
+#ifdef TS_HAVE_SSE2_STATS
+// OR-ing a value below 2^52 into the mantissa of 2^52 and subtracting 2^52
+// converts it exactly, without AVX-512's int64 conversions
+inline __m128d toDouble(__m128i v) {
+    const __m128i magic = _mm_set1_epi64x(0x4330000000000000LL);
+    return _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(v, magic)),
+                      _mm_set1_pd(kTwoPow52));
+}
+
+// Accumulates samples [1, returned index) two at a time
+std::size_t accumulateSse2(const std::int64_t* samples, std::size_t count,
+                           double target, Accumulator& acc) {
+    const __m128d targets  = _mm_set1_pd(target);
+    const __m128d signMask = _mm_set1_pd(-0.0);
+    __m128d sum            = _mm_setzero_pd();
+    __m128d sumSquares     = _mm_setzero_pd();
+    __m128d sumAbs         = _mm_setzero_pd();
+    __m128d min            = _mm_set1_pd(acc.min);
+    __m128d max            = _mm_set1_pd(acc.max);
+    __m128d maxJitter      = _mm_setzero_pd();
+
+    std::size_t i = 1;
+    for (; i + 2 <= count; i += 2) {
+        __m128d value = toDouble(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(samples + i)));
+        __m128d previous = toDouble(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(samples + i - 1)));
+        __m128d deviation = _mm_sub_pd(value, targets);
+        sum               = _mm_add_pd(sum, deviation);
+        sumSquares = _mm_add_pd(sumSquares, _mm_mul_pd(deviation, deviation));
+        sumAbs     = _mm_add_pd(sumAbs, _mm_andnot_pd(signMask, deviation));
+        min        = _mm_min_pd(min, value);
+        max        = _mm_max_pd(max, value);
+        maxJitter  = _mm_max_pd(
+            maxJitter,
+            _mm_andnot_pd(signMask, _mm_sub_pd(value, previous)));
+    }
+
+    alignas(16) double lanes[6][2];
+    _mm_store_pd(lanes[0], sum);
+    _mm_store_pd(lanes[1], sumSquares);
+    _mm_store_pd(lanes[2], sumAbs);
+    _mm_store_pd(lanes[3], min);
+    _mm_store_pd(lanes[4], max);
+    _mm_store_pd(lanes[5], maxJitter);
+    for (int lane = 0; lane < 2; ++lane) {
+        acc.sum += lanes[0][lane];
+        acc.sumSquares += lanes[1][lane];
+        acc.sumAbs += lanes[2][lane];
+        acc.min       = std::min(acc.min, lanes[3][lane]);
+        acc.max       = std::max(acc.max, lanes[4][lane]);
+        acc.maxJitter = std::max(acc.maxJitter, lanes[5][lane]);
+    }
+    return i;
+}
+#endif
+
+#ifdef TS_HAVE_AVX2_STATS
+__attribute__((target("avx2"))) inline __m256d toDouble(__m256i v) {
+    const __m256i magic = _mm256_set1_epi64x(0x4330000000000000LL);
+    return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, magic)),
+                         _mm256_set1_pd(kTwoPow52));
+}
+
+// Accumulates samples [1, returned index) four at a time
+__attribute__((target("avx2"))) std::size_t accumulateAvx2(
+    const std::int64_t* samples, std::size_t count, double target,
+    Accumulator& acc) {
+    const __m256d targets  = _mm256_set1_pd(target);
+    const __m256d signMask = _mm256_set1_pd(-0.0);
+    __m256d sum            = _mm256_setzero_pd();
+    __m256d sumSquares     = _mm256_setzero_pd();
+    __m256d sumAbs         = _mm256_setzero_pd();
+    __m256d min            = _mm256_set1_pd(acc.min);
+    __m256d max            = _mm256_set1_pd(acc.max);
+    __m256d maxJitter      = _mm256_setzero_pd();
+
+    std::size_t i = 1;
+    for (; i + 4 <= count; i += 4) {
+        __m256d value = toDouble(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(samples + i)));
+        __m256d previous = toDouble(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(samples + i - 1)));
+        __m256d deviation = _mm256_sub_pd(value, targets);
+        sum               = _mm256_add_pd(sum, deviation);
+        sumSquares        = _mm256_add_pd(sumSquares,
+                                          _mm256_mul_pd(deviation, deviation));
+        sumAbs = _mm256_add_pd(sumAbs, _mm256_andnot_pd(signMask, deviation));
+        min    = _mm256_min_pd(min, value);
+        max    = _mm256_max_pd(max, value);
+        maxJitter = _mm256_max_pd(
+            maxJitter,
+            _mm256_andnot_pd(signMask, _mm256_sub_pd(value, previous)));
+    }
+
+    alignas(32) double lanes[6][4];
+    _mm256_store_pd(lanes[0], sum);
+    _mm256_store_pd(lanes[1], sumSquares);
+    _mm256_store_pd(lanes[2], sumAbs);
+    _mm256_store_pd(lanes[3], min);
+    _mm256_store_pd(lanes[4], max);
+    _mm256_store_pd(lanes[5], maxJitter);
+    for (int lane = 0; lane < 4; ++lane) {
+        acc.sum += lanes[0][lane];
+        acc.sumSquares += lanes[1][lane];
+        acc.sumAbs += lanes[2][lane];
+        acc.min       = std::min(acc.min, lanes[3][lane]);
+        acc.max       = std::max(acc.max, lanes[4][lane]);
+        acc.maxJitter = std::max(acc.maxJitter, lanes[5][lane]);
+    }
+    return i;
+}
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+}  // anonymous namespace
+
+SampleSummary summarizeSamples(const std::int64_t* samples, std::size_t count,
+                               std::int64_t targetNs) {
+    if (count == 0) {
+        throw std::invalid_argument("No samples to summarize");
+    }
+
+    const double target = static_cast<double>(targetNs);
+    Accumulator acc{0.0,
+                    0.0,
+                    0.0,
+                    std::numeric_limits<double>::infinity(),
+                    -std::numeric_limits<double>::infinity(),
+                    0.0};
+
+    // The first sample has no predecessor to take a jitter against
+    accumulateScalar(samples, 0, 1, target, acc);
+    std::size_t done = 1;
+#if defined(TS_HAVE_AVX2_STATS)
+    done = cpuHasAvx2() ? accumulateAvx2(samples, count, target, acc)
+                        : accumulateSse2(samples, count, target, acc);
+#elif defined(TS_HAVE_SSE2_STATS)
+    done = accumulateSse2(samples, count, target, acc);
+#endif
+    accumulateScalar(samples, done, count, target, acc);
+
+    const double n          = static_cast<double>(count);
+    const double meanOffset = acc.sum / n;
+    const double variance =
+        std::max(acc.sumSquares / n - meanOffset * meanOffset, 0.0);
+
+    SampleSummary summary;
+    summary.count            = count;
+    summary.mean             = target + meanOffset;
+    summary.stddev           = std::sqrt(variance);
+    summary.min              = static_cast<std::int64_t>(acc.min);
+    summary.max              = static_cast<std::int64_t>(acc.max);
+    summary.meanAbsDeviation = acc.sumAbs / n;
+    summary.maxJitter        = static_cast<std::int64_t>(acc.maxJitter);
+    return summary;
+}
+
+const char* sampleKernelName() {
+#if defined(TS_HAVE_AVX2_STATS)
+    return cpuHasAvx2() ? "avx2" : "sse2";
+#elif defined(TS_HAVE_SSE2_STATS)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+}  // namespace ts
@@ -0,0 +1,190 @@
+#include "soak.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#include "logger.hpp"
+
+namespace ts {
+
+namespace {
+
+constexpr std::int64_t kNsPerMs   = 1000000;
+constexpr std::int64_t kNsPerSec  = 1000000000;
+constexpr std::int64_t kNsPerMin  = 60 * kNsPerSec;
+constexpr std::int64_t kNsPerHour = 60 * kNsPerMin;
+
+std::string lengthLabel(std::chrono::nanoseconds length) {
+    std::int64_t ns = length.count();
+    if (ns % kNsPerHour == 0) {
+        return std::to_string(ns / kNsPerHour) + "h";
+    }
+    if (ns % kNsPerMin == 0) {
+        return std::to_string(ns / kNsPerMin) + "m";
+    }
+    if (ns % kNsPerSec == 0) {
+        return std::to_string(ns / kNsPerSec) + "s";
+    }
+    return std::to_string(ns / kNsPerMs) + "ms";
+}
+
+}  // anonymous namespace
+
+std::vector<SoakWindow> parseSoakWindows(const std::string& list,
+                                         bool rolling) {
+    std::vector<SoakWindow> windows;
+    std::istringstream iss(list);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        std::istringstream in(item);
+        double value = 0.0;
+        std::string suffix;
+        in >> value;
+        if (!in.fail() && !in.eof()) {
+            in >> suffix;
+        }
+
+        double nsPerUnit = 0.0;
+        if (suffix.empty() || suffix == "s") {
+            nsPerUnit = static_cast<double>(kNsPerSec);
+        } else if (suffix == "ms") {
+            nsPerUnit = static_cast<double>(kNsPerMs);
+        } else if (suffix == "m" || suffix == "min") {
+            nsPerUnit = static_cast<double>(kNsPerMin);
+        } else if (suffix == "h") {
+            nsPerUnit = static_cast<double>(kNsPerHour);
+        }
+
+        // Rolling windows advance in tenths, so a millisecond is the floor
+        auto length = static_cast<std::int64_t>(value * nsPerUnit);
+        if (in.fail() || !in.eof() || nsPerUnit == 0.0 ||
+            length < kNsPerMs) {
+            throw std::invalid_argument("Invalid soak window list: " + list);
+        }
+        windows.push_back({std::chrono::nanoseconds(length), rolling});
+    }
+    if (windows.empty()) {
+        throw std::invalid_argument("Invalid soak window list: " + list);
+    }
+    return windows;
+}
+
+SoakAggregator::SoakAggregator(const std::vector<SoakWindow>& windows,
+                               const char* unit, double nanosecondsPerUnit,
+                               const std::atomic<std::uint64_t>& dropped)
+    : merged_(LatencyHistogram::kDefaultHighestTrackable, kHistogramBits),
+      unit_(unit),
+      nanosecondsPerUnit_(nanosecondsPerUnit),
+      dropped_(dropped) {
+    if (windows.empty()) {
+        throw std::invalid_argument("Soak mode needs at least one window");
+    }
+    tracks_.reserve(windows.size());
+    for (const SoakWindow& window : windows) {
+        std::size_t slices =
+            window.rolling ? static_cast<std::size_t>(kRollingSlices) : 1;
+        Track track{window,
+                    window.length.count() / static_cast<std::int64_t>(slices),
+                    {},
+                    0,
+                    1,
+                    0,
+                    0};
+        track.slices.reserve(slices);
+        for (std::size_t i = 0; i < slices; ++i) {
+            track.slices.emplace_back(
+                LatencyHistogram::kDefaultHighestTrackable, kHistogramBits);
+        }
+        tracks_.push_back(std::move(track));
+    }
+}
+
+void SoakAggregator::start(std::int64_t startNs) {
+    startNs_ = startNs;
+    lastNs_  = startNs;
+    for (Track& track : tracks_) {
+        for (LatencyHistogram& slice : track.slices) {
+            slice.reset();
+        }
+        track.current        = 0;
+        track.filled         = 1;
+        track.sliceEndNs     = startNs + track.sliceNs;
+        track.droppedAtStart = dropped_.load(std::memory_order_relaxed);
+    }
+}
+
+void SoakAggregator::add(std::int64_t timestampNs, std::int64_t intervalNs) {
+    lastNs_ = timestampNs;
+    auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(intervalNs, 0));
+    for (Track& track : tracks_) {
+        while (timestampNs >= track.sliceEndNs) {
+            closeSlice(track);
+        }
+        track.slices[track.current].record(ns);
+    }
+}
+
+void SoakAggregator::finish() {
+    for (Track& track : tracks_) {
+        report(track, lastNs_, true);
+    }
+}
+
+void SoakAggregator::closeSlice(Track& track) {
+    std::size_t slices = track.slices.size();
+    report(track, track.sliceEndNs, track.filled < slices);
+
+    track.current = (track.current + 1) % slices;
+    track.filled  = std::min(track.filled + 1, slices);
+    // Resetting walks the whole bucket array; skip it for slices that stayed
+    // empty, e.g. while the timer was stalled for many windows
+    LatencyHistogram& next = track.slices[track.current];
+    if (next.count() > 0) {
+        next.reset();
+    }
+    track.sliceEndNs += track.sliceNs;
+}
+
+void SoakAggregator::report(Track& track, std::int64_t endNs, bool partial) {
+    const LatencyHistogram* window = &track.slices.front();
+    if (track.slices.size() > 1) {
+        merged_.reset();
+        for (const LatencyHistogram& slice : track.slices) {
+            if (slice.count() > 0) {
+                merged_.merge(slice);
+            }
+        }
+        window = &merged_;
+    }
+    if (window->count() == 0) {
+        return;
+    }
+
+    std::uint64_t dropped         = dropped_.load(std::memory_order_relaxed);
+    std::uint64_t droppedInWindow = dropped - track.droppedAtStart;
+    track.droppedAtStart          = dropped;
+
+    // Formatted locally so the logger's stream state is left alone and the
+    // line reaches it in one piece
+    ::utils::TimingStats stats = makeTimingStats(*window, nanosecondsPerUnit_);
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2);
+    line << "[soak " << lengthLabel(track.window.length)
+         << (track.window.rolling ? " rolling" : " tumbling")
+         << (partial ? ", partial" : "") << "] +"
+         << static_cast<double>(endNs - startNs_) / kNsPerSec
+         << " s: count " << stats.count << ", avg " << stats.average
+         << ", p50 " << stats.p50 << ", p99 " << stats.p99 << ", p99.9 "
+         << stats.p999 << ", max "
+         << static_cast<double>(window->max()) / nanosecondsPerUnit_ << " "
+         << unit_;
+    if (droppedInWindow > 0) {
+        line << ", dropped " << droppedInWindow;
+    }
+    line << "\n";
+    logger << line.str();
+}
+
+}  // namespace ts
@@ -0,0 +1,155 @@
+#include "spin_scheduler.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+// Oversleep histograms: coarse precision is plenty for picking a margin
+constexpr std::uint64_t kOversleepRange = 10ULL * 1000000000ULL;
+constexpr int kOversleepBits            = 7;
+
+// Re-derive the margin from the histograms every this many samples
+constexpr std::uint64_t kUpdateEvery = 16;
+
+// Extra allowance on top of the p99 oversleep, as a fraction of it
+constexpr double kSafetyFactor = 1.25;
+
+// Margin used before enough samples are seen; the historical fixed value
+constexpr std::chrono::nanoseconds kInitialMargin{10000000};
+
+}  // anonymous namespace
+
+AdaptiveSpinScheduler::AdaptiveSpinScheduler(std::chrono::nanoseconds interval)
+    : maxMargin_(std::max(interval / 2, kMinMargin)),
+      margin_(std::min(kInitialMargin, maxMargin_)),
+      windows_{LatencyHistogram(kOversleepRange, kOversleepBits),
+               LatencyHistogram(kOversleepRange, kOversleepBits)} {}
+
+void AdaptiveSpinScheduler::setFixedMargin(std::chrono::nanoseconds margin) {
+    adaptive_    = false;
+    fixedMargin_ = margin;
+    margin_ = std::clamp(margin, std::chrono::nanoseconds(0), maxMargin_);
+}
+
+void AdaptiveSpinScheduler::setInterval(std::chrono::nanoseconds interval) {
+    maxMargin_ = std::max(interval / 2, kMinMargin);
+    margin_    = adaptive_ ? std::min(kInitialMargin, maxMargin_)
+                           : std::clamp(fixedMargin_,
+                                        std::chrono::nanoseconds(0),
+                                        maxMargin_);
+}
+
+void AdaptiveSpinScheduler::begin() {
+    windows_[0].reset();
+    windows_[1].reset();
+    current_       = 0;
+    wakeups_       = 0;
+    missedWakeups_ = 0;
+    sleepTime_     = std::chrono::nanoseconds(0);
+    spinTime_      = std::chrono::nanoseconds(0);
+    cpuTime_       = std::chrono::nanoseconds(0);
+    if (adaptive_) {
+        margin_ = std::min(kInitialMargin, maxMargin_);
+    }
+    cpuStart_ = threadCpuTime();
+}
+
+void AdaptiveSpinScheduler::end() {
+    cpuTime_ = threadCpuTime() - cpuStart_;
+}
+
+void AdaptiveSpinScheduler::record(std::chrono::nanoseconds sleepTime,
+                                   std::chrono::nanoseconds oversleep,
+                                   std::chrono::nanoseconds spinTime,
+                                   bool missedDeadline) {
+    ++wakeups_;
+    sleepTime_ += sleepTime;
+    spinTime_ += spinTime;
+    if (missedDeadline) {
+        ++missedWakeups_;
+    }
+    if (!adaptive_) {
+        return;
+    }
+
+    LatencyHistogram& window = windows_[current_];
+    window.record(static_cast<std::uint64_t>(
+        std::max<std::int64_t>(oversleep.count(), 0)));
+    if (window.count() >= kWindowSamples) {
+        current_ ^= 1;
+        windows_[current_].reset();
+    }
+
+    if (missedDeadline) {
+        margin_ = std::min(margin_ * 2, maxMargin_);
+    } else if (wakeups_ % kUpdateEvery == 0) {
+        updateMargin();
+    }
+}
+
+void AdaptiveSpinScheduler::updateMargin() {
+    if (windows_[0].count() + windows_[1].count() < kWarmupSamples) {
+        return;
+    }
+    std::uint64_t p99 = std::max(windows_[0].valueAtPercentile(0.99),
+                                 windows_[1].valueAtPercentile(0.99));
+    auto learned      = std::chrono::nanoseconds(
+        static_cast<std::int64_t>(static_cast<double>(p99) * kSafetyFactor));
+    margin_ = std::clamp(learned + kMinMargin, kMinMargin, maxMargin_);
+}
+
+AdaptiveSpinScheduler::Report AdaptiveSpinScheduler::report() const {
+    Report r{};
+    r.wakeups       = wakeups_;
+    r.missedWakeups = missedWakeups_;
+    r.sleepTime     = sleepTime_;
+    r.spinTime      = spinTime_;
+    r.finalMargin   = margin_;
+    r.p99Oversleep  = std::chrono::nanoseconds(
+        std::max(windows_[0].valueAtPercentile(0.99),
+                 windows_[1].valueAtPercentile(0.99)));
+    r.cpuTime       = cpuTime_;
+    r.adaptive      = adaptive_;
+    return r;
+}
+
+std::chrono::nanoseconds AdaptiveSpinScheduler::threadCpuTime() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetThreadTimes(GetCurrentThread(), &creation, &exitTime, &kernel,
+                        &user)) {
+        return std::chrono::nanoseconds(0);
+    }
+    auto toNs = [](const FILETIME& ft) {
+        ULARGE_INTEGER v;
+        v.LowPart  = ft.dwLowDateTime;
+        v.HighPart = ft.dwHighDateTime;
+        return static_cast<long long>(v.QuadPart) * 100;
+    };
+    return std::chrono::nanoseconds(toNs(kernel) + toNs(user));
+#else
+    timespec cpu{};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu) != 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    return std::chrono::seconds(cpu.tv_sec) +
+           std::chrono::nanoseconds(cpu.tv_nsec);
+#endif
+}
+
+}  // namespace ts
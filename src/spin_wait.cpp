@@ -0,0 +1,122 @@
+#include "spin_wait.hpp"
+
+#include <stdexcept>
+
+#include "clock_source.hpp"
+
+#if defined(TS_HAVE_TSC_CLOCK) && (defined(__GNUC__) || defined(__clang__))
+#define TS_HAVE_TPAUSE 1
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace ts {
+
+namespace {
+
+// TPAUSE control: 1 selects C0.1, the state with the faster wake-up
+constexpr unsigned int kTpauseC01 = 1;
+
+// Longest single TPAUSE; the OS may cap it lower (IA32_UMWAIT_CONTROL)
+constexpr double kMaxTpauseNs = 20000.0;
+
+}  // anonymous namespace
+
+SpinPolicy parseSpinPolicy(const std::string& name) {
+    if (name == "auto") return SpinPolicy::Auto;
+    if (name == "raw") return SpinPolicy::Raw;
+    if (name == "pause") return SpinPolicy::Pause;
+    if (name == "tpause") return SpinPolicy::Tpause;
+    if (name == "yield") return SpinPolicy::Yield;
+    throw std::invalid_argument("Invalid spin policy: " + name +
+                                " (expected auto, raw, pause, tpause or "
+                                "yield)");
+}
+
+const char* spinPolicyName(SpinPolicy policy) {
+    switch (policy) {
+    case SpinPolicy::Auto:
+        return "auto";
+    case SpinPolicy::Raw:
+        return "raw";
+    case SpinPolicy::Pause:
+        return "pause";
+    case SpinPolicy::Tpause:
+        return "tpause";
+    case SpinPolicy::Yield:
+        return "yield";
+    }
+    return "unknown";
+}
+
+bool cpuHasWaitpkg() {
+#ifdef TS_HAVE_TPAUSE
+    static const bool supported = [] {
+        unsigned int eax, ebx, ecx, edx;
+        if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            return false;
+        }
+        return (ecx & (1u << 5)) != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+SpinRelax::SpinRelax(SpinPolicy policy)
+    : requested_(policy), policy_(policy) {
+    if (policy != SpinPolicy::Auto && policy != SpinPolicy::Tpause) {
+        return;
+    }
+
+    // TPAUSE takes a TSC deadline, so it also needs the TSC rate
+    std::string reason;
+    if (!cpuHasWaitpkg()) {
+        reason = "CPU does not report WAITPKG";
+    } else if (!tscCalibration().usable) {
+        reason = tscCalibration().reason;
+    }
+
+    if (reason.empty()) {
+        policy_             = SpinPolicy::Tpause;
+        ticksPerNanosecond_ = tscCalibration().ticksPerNanosecond;
+    } else {
+        policy_ = SpinPolicy::Pause;
+        if (policy == SpinPolicy::Tpause) {
+            fallbackReason_ = reason;
+        }
+    }
+}
+
+#ifdef TS_HAVE_TPAUSE
+__attribute__((target("waitpkg"))) void SpinRelax::tpauseFor(
+    std::chrono::nanoseconds remaining) const noexcept {
+    // Sleep through half of what is left, leaving the rest for the wake-up
+    // and the final polls
+    double ns = static_cast<double>(remaining.count()) / 2;
+    if (ns > kMaxTpauseNs) {
+        ns = kMaxTpauseNs;
+    }
+    _tpause(kTpauseC01,
+            __rdtsc() + static_cast<std::uint64_t>(ns * ticksPerNanosecond_));
+}
+#else
+void SpinRelax::tpauseFor(std::chrono::nanoseconds remaining) const noexcept {
+    // Never selected on this platform
+    pauseFor(remaining);
+}
+#endif
+
+std::string SpinRelax::describe() const {
+    std::string text = spinPolicyName(policy_);
+    if (requested_ == SpinPolicy::Auto) {
+        text += " (auto)";
+    } else if (!fallbackReason_.empty()) {
+        text += std::string(" (") + spinPolicyName(requested_) +
+                " unavailable: " + fallbackReason_ + ")";
+    }
+    return text;
+}
+
+}  // namespace ts
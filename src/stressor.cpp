@@ -0,0 +1,300 @@
+#include "stressor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "multi_core_engine.hpp"
+#include "realtime.hpp"
+
+namespace ts {
+
+namespace {
+
+// Size of each of the two buffers a memory stressor thread copies between
+constexpr std::size_t kStreamBytes = 64u << 20;
+
+// Cache stressor buffer when the last-level cache size cannot be read
+constexpr std::size_t kDefaultCacheBytes = 32u << 20;
+
+constexpr std::size_t kCacheLine = 64;
+
+// Live allocations an allocator stressor thread keeps
+constexpr std::size_t kAllocSlots = 4096;
+
+// Work between two checks of the stop flag
+constexpr int kBatch = 1024;
+
+std::int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::uint64_t xorshift(std::uint64_t& x) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    return x;
+}
+
+// Largest unified or data cache of CPU 0, e.g. "32768K" in sysfs
+std::size_t lastLevelCacheBytes() {
+    std::size_t largest = 0;
+    for (int index = 0; index < 8; ++index) {
+        std::ifstream in("/sys/devices/system/cpu/cpu0/cache/index" +
+                         std::to_string(index) + "/size");
+        std::string text;
+        if (!(in >> text)) {
+            continue;
+        }
+        std::size_t value = std::strtoull(text.c_str(), nullptr, 10);
+        if (text.back() == 'K') value <<= 10;
+        if (text.back() == 'M') value <<= 20;
+        largest = std::max(largest, value);
+    }
+    return largest > 0 ? largest : kDefaultCacheBytes;
+}
+
+int parseThreads(const std::string& text, const std::string& spec) {
+    std::istringstream in(text);
+    int threads = 0;
+    in >> threads;
+    if (in.fail() || !in.eof() || threads < 1 || threads > 4096) {
+        throw std::invalid_argument("Invalid stressor thread count: " + spec);
+    }
+    return threads;
+}
+
+}  // anonymous namespace
+
+StressorKind parseStressorKind(const std::string& name) {
+    if (name == "spin") return StressorKind::Spin;
+    if (name == "memory") return StressorKind::Memory;
+    if (name == "cache") return StressorKind::Cache;
+    if (name == "syscall") return StressorKind::Syscall;
+    if (name == "alloc") return StressorKind::Alloc;
+    throw std::invalid_argument("Invalid stressor: " + name +
+                                " (expected spin, memory, cache, syscall "
+                                "or alloc)");
+}
+
+const char* stressorKindName(StressorKind kind) {
+    switch (kind) {
+    case StressorKind::Spin:
+        return "spin";
+    case StressorKind::Memory:
+        return "memory";
+    case StressorKind::Cache:
+        return "cache";
+    case StressorKind::Syscall:
+        return "syscall";
+    case StressorKind::Alloc:
+        return "alloc";
+    }
+    return "unknown";
+}
+
+StressorSpec parseStressorSpec(const std::string& spec) {
+    StressorSpec result;
+    result.label = spec;
+
+    std::string head = spec;
+    std::size_t at  = spec.find('@');
+    if (at != std::string::npos) {
+        std::string placement = spec.substr(at + 1);
+        head                  = spec.substr(0, at);
+        if (placement == "sibling") {
+            result.sibling = true;
+        } else {
+            result.cpus = parseCpuList(placement);
+        }
+    }
+
+    std::size_t colon = head.find(':');
+    result.kind       = parseStressorKind(head.substr(0, colon));
+    if (colon != std::string::npos) {
+        result.threads = parseThreads(head.substr(colon + 1), spec);
+    }
+    return result;
+}
+
+std::vector<int> smtSiblingsOf(int cpu) {
+    std::ifstream in("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                     "/topology/thread_siblings_list");
+    std::string list;
+    if (!std::getline(in, list)) {
+        return {};
+    }
+    std::vector<int> siblings = parseCpuList(list);
+    siblings.erase(std::remove(siblings.begin(), siblings.end(), cpu),
+                   siblings.end());
+    return siblings;
+}
+
+StressorGroup::StressorGroup(const StressorSpec& spec)
+    : spec_(spec),
+      pinErrors_(),
+      work_(std::make_unique<WorkCounter[]>(
+          static_cast<std::size_t>(spec.threads))) {}
+
+StressorGroup::~StressorGroup() {
+    stop();
+}
+
+void StressorGroup::start() {
+    stop_.store(false, std::memory_order_relaxed);
+    pinErrors_.clear();
+    startNs_ = steadyNowNs();
+    for (int t = 0; t < spec_.threads; ++t) {
+        work_[t].done.store(0, std::memory_order_relaxed);
+        threads_.emplace_back(&StressorGroup::work, this,
+                              static_cast<std::size_t>(t));
+    }
+}
+
+double StressorGroup::stop() {
+    if (threads_.empty()) {
+        return 0.0;
+    }
+    stop_.store(true, std::memory_order_relaxed);
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+
+    double seconds = static_cast<double>(steadyNowNs() - startNs_) / 1e9;
+    double total   = 0.0;
+    for (int t = 0; t < spec_.threads; ++t) {
+        total += static_cast<double>(
+            work_[t].done.load(std::memory_order_relaxed));
+    }
+    // Bytes are reported in GB, everything else in millions
+    double scale = spec_.kind == StressorKind::Memory ? 1e9 : 1e6;
+    return seconds > 0 ? total / scale / seconds : 0.0;
+}
+
+const char* StressorGroup::rateUnit() const {
+    switch (spec_.kind) {
+    case StressorKind::Spin:
+        return "Mops/s";
+    case StressorKind::Memory:
+        return "GB/s";
+    case StressorKind::Cache:
+        return "Mlines/s";
+    case StressorKind::Syscall:
+        return "Mcalls/s";
+    case StressorKind::Alloc:
+        return "Mallocs/s";
+    }
+    return "";
+}
+
+void StressorGroup::work(std::size_t thread) {
+    if (!spec_.cpus.empty()) {
+        std::string error;
+        if (!pinCurrentThread(spec_.cpus[thread % spec_.cpus.size()],
+                              error)) {
+            // Reported once the threads have stopped
+            std::lock_guard<std::mutex> lock(pinErrorMutex_);
+            pinErrors_.push_back(error);
+        }
+    }
+
+    std::atomic<std::uint64_t>& done = work_[thread].done;
+    std::atomic<std::uint64_t>& sink = work_[thread].sink;
+    std::uint64_t x = 88172645463325252ULL + thread * 0x9E3779B97F4A7C15ULL;
+
+    switch (spec_.kind) {
+    case StressorKind::Spin: {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < kBatch; ++i) {
+                xorshift(x);
+            }
+            // Without a use of x the whole batch folds away
+            sink.store(x, std::memory_order_relaxed);
+            done.fetch_add(kBatch, std::memory_order_relaxed);
+        }
+        break;
+    }
+    case StressorKind::Memory: {
+        std::vector<char> from(kStreamBytes, 1);
+        std::vector<char> to(kStreamBytes, 0);
+        while (!stop_.load(std::memory_order_relaxed)) {
+            std::memcpy(to.data(), from.data(), kStreamBytes);
+            from.swap(to);
+            done.fetch_add(2 * kStreamBytes, std::memory_order_relaxed);
+        }
+        break;
+    }
+    case StressorKind::Cache: {
+        // A stride of about 0.618 of the buffer, coprime with its line
+        // count, visits every line in an order no prefetcher follows
+        const std::size_t lines = lastLevelCacheBytes() / kCacheLine;
+        std::vector<char> buffer(lines * kCacheLine, 0);
+        std::size_t stride = static_cast<std::size_t>(lines * 0.618) | 1;
+        while (std::gcd(stride, lines) != 1) {
+            stride += 2;
+        }
+        std::size_t line = 0;
+        while (!stop_.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < kBatch; ++i) {
+                ++buffer[line * kCacheLine];
+                line = (line + stride) % lines;
+            }
+            sink.store(static_cast<std::uint64_t>(buffer[line * kCacheLine]),
+                       std::memory_order_relaxed);
+            done.fetch_add(kBatch, std::memory_order_relaxed);
+        }
+        break;
+    }
+    case StressorKind::Syscall: {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < kBatch; ++i) {
+#ifdef __linux__
+                ::syscall(SYS_getppid);
+#else
+                std::this_thread::yield();
+#endif
+            }
+            done.fetch_add(kBatch, std::memory_order_relaxed);
+        }
+        break;
+    }
+    case StressorKind::Alloc: {
+        // Sizes from 16 bytes to 256 KiB, the largest above glibc's
+        // default mmap threshold
+        std::vector<void*> slots(kAllocSlots, nullptr);
+        while (!stop_.load(std::memory_order_relaxed)) {
+            for (int i = 0; i < kBatch; ++i) {
+                std::uint64_t r  = xorshift(x);
+                void*& slot      = slots[r % kAllocSlots];
+                std::size_t size = std::size_t(16) << ((r >> 32) % 15);
+                std::free(slot);
+                slot = std::malloc(size);
+                if (slot != nullptr) {
+                    static_cast<char*>(slot)[0]        = 1;
+                    static_cast<char*>(slot)[size - 1] = 1;
+                }
+            }
+            done.fetch_add(kBatch, std::memory_order_relaxed);
+        }
+        for (void* slot : slots) {
+            std::free(slot);
+        }
+        break;
+    }
+    }
+}
+
+}  // namespace ts
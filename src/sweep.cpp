@@ -0,0 +1,266 @@
+#include "sweep.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <variant>
+
+#include "logger.hpp"
+
+namespace ts {
+
+namespace {
+
+std::size_t parsePositiveCount(const std::string& item,
+                               const std::string& list) {
+    std::istringstream in(item);
+    unsigned long long value = 0;
+    in >> value;
+    if (in.fail() || !in.eof() || item.empty() || item[0] == '-' ||
+        value == 0) {
+        throw std::invalid_argument("Invalid sweep iteration list: " + list);
+    }
+    return static_cast<std::size_t>(value);
+}
+
+// Timer statistics are in the timer's unit; the table uses microseconds
+::utils::TimingStats toMicroseconds(::utils::TimingStats stats,
+                                    double nanosecondsPerUnit) {
+    double factor = nanosecondsPerUnit / 1e3;
+    for (double* field :
+         {&stats.average, &stats.p50, &stats.p75, &stats.p90, &stats.p95,
+          &stats.p99, &stats.p999, &stats.p9999, &stats.stddev, &stats.min,
+          &stats.max, &stats.meanAbsDeviation, &stats.maxJitter}) {
+        *field *= factor;
+    }
+    return stats;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(),
+                        suffix) == 0;
+}
+
+}  // anonymous namespace
+
+std::vector<double> parseSweepIntervals(const std::string& spec) {
+    std::vector<double> intervals;
+
+    if (spec.find(':') != std::string::npos) {
+        std::istringstream in(spec);
+        std::string start, stop, count;
+        std::getline(in, start, ':');
+        std::getline(in, stop, ':');
+        std::getline(in, count);
+        double first      = ::utils::parseInterval(start.c_str());
+        double last       = ::utils::parseInterval(stop.c_str());
+        std::size_t steps = parsePositiveCount(count, spec);
+        if (steps == 1) {
+            return {first};
+        }
+        // Equal ratios between neighbours, so every decade gets the same
+        // number of steps
+        double ratio = std::pow(last / first, 1.0 / (steps - 1));
+        for (std::size_t i = 0; i < steps; ++i) {
+            intervals.push_back(i + 1 == steps
+                                    ? last
+                                    : first * std::pow(ratio, i));
+        }
+        return intervals;
+    }
+
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        intervals.push_back(::utils::parseInterval(item.c_str()));
+    }
+    if (intervals.empty()) {
+        throw std::invalid_argument("Invalid sweep: " + spec);
+    }
+    return intervals;
+}
+
+std::vector<std::size_t> parseSweepIterations(const std::string& list) {
+    std::vector<std::size_t> counts;
+    std::istringstream in(list);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        counts.push_back(parsePositiveCount(item, list));
+    }
+    if (counts.empty()) {
+        throw std::invalid_argument("Invalid sweep iteration list: " + list);
+    }
+    return counts;
+}
+
+SweepRunner::SweepRunner(const Options& options) : options_(options) {
+    if (options_.sweepIntervals.empty() || options_.sweepIterations.empty()) {
+        throw std::invalid_argument(
+            "A sweep needs at least one interval and iteration count");
+    }
+}
+
+BaseTimer& SweepRunner::retarget(AnyTimer& timer, double intervalSec) {
+    return std::visit(
+        [intervalSec](auto& t) -> BaseTimer& {
+            t->setInterval(intervalSec);
+            return *t;
+        },
+        timer);
+}
+
+std::vector<SweepResult> SweepRunner::run() {
+    const std::size_t steps =
+        options_.sweepIntervals.size() * options_.sweepIterations.size();
+    std::vector<SweepResult> results;
+    results.reserve(steps);
+
+    std::size_t step = 0;
+    for (double intervalSec : options_.sweepIntervals) {
+        Options stepOptions     = options_;
+        stepOptions.intervalSec = intervalSec;
+        bool highRes            = usesHighResTimer(stepOptions);
+
+        std::optional<AnyTimer>& slot =
+            highRes ? busySpinTimer_ : sleepSpinTimer_;
+        if (!slot) {
+            // Steps are reported in one table, not tick by tick, so the
+            // timer never starts an output thread
+            slot = createTimer(stepOptions);
+            baseTimer(*slot).setTickOutput(false);
+        }
+        BaseTimer& timer = retarget(*slot, intervalSec);
+        const char* name = highRes ? "HighResTimer" : "Timer";
+
+        for (std::size_t iterations : options_.sweepIterations) {
+            if (stopRequested_.load(std::memory_order_relaxed)) {
+                return results;
+            }
+            logger << "Sweep step " << ++step << "/" << steps
+                   << ": interval = " << intervalSec << " s, " << iterations
+                   << " iterations (" << name << ")\n";
+
+            current_.store(&timer, std::memory_order_release);
+            std::visit([&](auto& t) { t->run(iterations); }, *slot);
+            current_.store(nullptr, std::memory_order_release);
+
+            if (timer.getHistogram().count() > 0) {
+                results.push_back(
+                    {intervalSec, iterations, name,
+                     toMicroseconds(timer.calculateStatistics(),
+                                    timer.getNanosecondsPerUnit())});
+            }
+        }
+    }
+    return results;
+}
+
+void SweepRunner::requestStop() {
+    stopRequested_.store(true, std::memory_order_relaxed);
+    if (BaseTimer* timer = current_.load(std::memory_order_acquire)) {
+        timer->requestStop();
+    }
+}
+
+void printSweepTable(const std::vector<SweepResult>& results) {
+    auto jitter = [](double value) {
+        std::ostringstream text;
+        if (std::isnan(value)) {
+            text << "n/a";
+        } else {
+            text << std::fixed << std::setprecision(2) << value;
+        }
+        return text.str();
+    };
+
+    logger << std::fixed << std::setprecision(2);
+    logger << "\n========== Sweep (us) ==========\n"
+           << std::setw(12) << "interval(s)" << std::setw(11) << "iterations"
+           << std::setw(14) << "timer" << std::setw(12) << "average"
+           << std::setw(10) << "stddev" << std::setw(12) << "p50"
+           << std::setw(12) << "p99" << std::setw(12) << "p99.9"
+           << std::setw(12) << "max" << std::setw(10) << "jitter"
+           << "\n";
+    for (const SweepResult& r : results) {
+        std::ostringstream interval;
+        interval << r.intervalSec;
+        logger << std::setw(12) << interval.str() << std::setw(11)
+               << r.iterations << std::setw(14) << r.timer << std::setw(12)
+               << r.stats.average << std::setw(10) << r.stats.stddev
+               << std::setw(12) << r.stats.p50 << std::setw(12)
+               << r.stats.p99 << std::setw(12) << r.stats.p999
+               << std::setw(12) << r.stats.max << std::setw(10)
+               << jitter(r.stats.maxJitter) << "\n";
+    }
+    logger << "================================\n";
+}
+
+void writeSweepReport(const std::vector<SweepResult>& results,
+                      const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open sweep report: " + path);
+    }
+    const bool json = endsWith(path, ".json");
+
+    // Jitter is unknown for steps longer than the raw capture limit
+    auto number = [json](double value) {
+        std::ostringstream text;
+        if (std::isnan(value)) {
+            text << (json ? "null" : "");
+        } else {
+            text << std::fixed << std::setprecision(3) << value;
+        }
+        return text.str();
+    };
+
+    if (json) {
+        out << "{\n  \"unit\": \"us\",\n  \"steps\": [\n";
+    } else {
+        out << "interval_s,iterations,timer,count,average_us,stddev_us,"
+               "min_us,p50_us,p90_us,p99_us,p999_us,p9999_us,max_us,"
+               "mean_abs_deviation_us,max_jitter_us\n";
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const SweepResult& r          = results[i];
+        const ::utils::TimingStats& s = r.stats;
+        if (json) {
+            out << "    {\"interval_s\": " << r.intervalSec
+                << ", \"iterations\": " << r.iterations << ", \"timer\": \""
+                << r.timer << "\", \"count\": " << s.count
+                << ", \"average\": " << number(s.average)
+                << ", \"stddev\": " << number(s.stddev)
+                << ", \"min\": " << number(s.min)
+                << ", \"p50\": " << number(s.p50)
+                << ", \"p90\": " << number(s.p90)
+                << ", \"p99\": " << number(s.p99)
+                << ", \"p999\": " << number(s.p999)
+                << ", \"p9999\": " << number(s.p9999)
+                << ", \"max\": " << number(s.max)
+                << ", \"mean_abs_deviation\": "
+                << number(s.meanAbsDeviation)
+                << ", \"max_jitter\": " << number(s.maxJitter) << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        } else {
+            out << r.intervalSec << "," << r.iterations << "," << r.timer
+                << "," << s.count << "," << number(s.average) << ","
+                << number(s.stddev) << "," << number(s.min) << ","
+                << number(s.p50) << "," << number(s.p90) << ","
+                << number(s.p99) << "," << number(s.p999) << ","
+                << number(s.p9999) << "," << number(s.max) << ","
+                << number(s.meanAbsDeviation) << ","
+                << number(s.maxJitter) << "\n";
+        }
+    }
+    if (json) {
+        out << "  ]\n}\n";
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write sweep report: " + path);
+    }
+}
+
+}  // namespace ts
@@ -0,0 +1,128 @@
+#include "tick_trace.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <stdexcept>
+
+namespace ts {
+
+namespace {
+
+std::size_t roundUpToCacheLine(std::size_t bytes) {
+    return (bytes + TickTrace::kCacheLine - 1) & ~(TickTrace::kCacheLine - 1);
+}
+
+}  // anonymous namespace
+
+TickTrace::~TickTrace() {
+    release();
+}
+
+void TickTrace::release() {
+    if (block_ != nullptr) {
+        ::operator delete(block_, std::align_val_t(kCacheLine));
+        block_ = nullptr;
+    }
+    capacity_ = 0;
+}
+
+std::size_t TickTrace::blockBytes(std::size_t capacity) {
+    return roundUpToCacheLine(capacity * sizeof(std::int64_t)) * 5;
+}
+
+void TickTrace::reset(std::size_t capacity) {
+    size_     = 0;
+    overflow_ = 0;
+    startNs_  = 0;
+    // A caller's block may be gone by now, so only an owned one is reused
+    if (capacity <= capacity_ && block_ != nullptr) {
+        return;
+    }
+
+    release();
+    block_ = ::operator new(blockBytes(capacity), std::align_val_t(kCacheLine));
+    carve(block_, capacity);
+}
+
+void TickTrace::reset(std::size_t capacity, void* block) {
+    size_     = 0;
+    overflow_ = 0;
+    startNs_  = 0;
+    release();
+    carve(block, capacity);
+}
+
+void TickTrace::carve(void* block, std::size_t capacity) {
+    std::size_t stride = roundUpToCacheLine(capacity * sizeof(std::int64_t));
+    auto* base         = static_cast<unsigned char*>(block);
+    deadlineNs_        = reinterpret_cast<std::int64_t*>(base);
+    wokeNs_            = reinterpret_cast<std::int64_t*>(base + stride);
+    spins_             = reinterpret_cast<std::uint64_t*>(base + stride * 2);
+    observedNs_        = reinterpret_cast<std::int64_t*>(base + stride * 3);
+    enqueueNs_         = reinterpret_cast<std::int64_t*>(base + stride * 4);
+    capacity_          = capacity;
+}
+
+void TickTrace::writeChromeTrace(const std::string& path,
+                                 const char* clockName) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Failed to create trace file: " + path +
+                                 " (" + std::strerror(errno) + ")");
+    }
+
+    // Chrome trace timestamps are microseconds relative to the run start
+    auto us = [this](std::int64_t ns) {
+        return static_cast<double>(ns - startNs_) / 1e3;
+    };
+    auto span = [](std::int64_t ns) {
+        return static_cast<double>(ns) / 1e3;
+    };
+    const char* thread = "\"pid\":1,\"tid\":1";
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[\n"
+        << "{\"name\":\"thread_name\",\"ph\":\"M\"," << thread
+        << ",\"args\":{\"name\":\"timing thread (" << clockName << ")\"}}";
+
+    std::int64_t previousNs = startNs_;
+    for (std::size_t i = 0; i < size_; ++i) {
+        std::int64_t woke     = wokeNs_[i];
+        std::int64_t observed = observedNs_[i];
+        if (woke > previousNs) {
+            out << ",\n{\"name\":\"sleep\",\"ph\":\"X\"," << thread
+                << ",\"ts\":" << us(previousNs)
+                << ",\"dur\":" << span(woke - previousNs)
+                << ",\"args\":{\"tick\":" << i << "}}";
+        } else {
+            woke = previousNs;
+        }
+        out << ",\n{\"name\":\"spin\",\"ph\":\"X\"," << thread
+            << ",\"ts\":" << us(woke) << ",\"dur\":" << span(observed - woke)
+            << ",\"args\":{\"tick\":" << i << ",\"spins\":" << spins_[i]
+            << "}}"
+            << ",\n{\"name\":\"enqueue\",\"ph\":\"X\"," << thread
+            << ",\"ts\":" << us(observed) << ",\"dur\":" << span(enqueueNs_[i])
+            << ",\"args\":{\"tick\":" << i << "}}"
+            << ",\n{\"name\":\"deadline\",\"ph\":\"i\",\"s\":\"t\"," << thread
+            << ",\"ts\":" << us(deadlineNs_[i]) << ",\"args\":{\"tick\":" << i
+            << "}}"
+            << ",\n{\"name\":\"lateness (us)\",\"ph\":\"C\",\"pid\":1"
+            << ",\"ts\":" << us(observed)
+            << ",\"args\":{\"lateness\":" << span(observed - deadlineNs_[i])
+            << "}}";
+        previousNs = observed + enqueueNs_[i];
+    }
+
+    out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"clock\":\""
+        << clockName << "\",\"ticks\":" << size_
+        << ",\"untracedTicks\":" << overflow_ << "}}\n";
+    if (!out) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+}  // namespace ts
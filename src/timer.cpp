@@ -1,104 +1,34 @@
 #include "timer.hpp"
 
 #include <chrono>
-#include <iostream>
-#include <thread>
 
-#ifdef _WIN32
-#ifndef WIN32_LEAN_AND_MEAN
-#define WIN32_LEAN_AND_MEAN
-#endif
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
-
-#include <windows.h>
-
-#include <mmsystem.h>
-
-namespace {
-
-class TimerResolutionGuard {
-public:
-    explicit TimerResolutionGuard(UINT period) : period_(period) {
-        timeBeginPeriod(period_);
-    }
-
-    ~TimerResolutionGuard() {
-        timeEndPeriod(period_);
-    }
-
-    TimerResolutionGuard(const TimerResolutionGuard&)            = delete;
-    TimerResolutionGuard& operator=(const TimerResolutionGuard&) = delete;
-
-private:
-    UINT period_;
-};
-
-}  // anonymous namespace
-
-#endif
-
-#include "utils.hpp"
+#include "logger.hpp"
 
 namespace ts {
 
-Timer::Timer(double intervalSec) : BaseTimer(intervalSec, "ms") {}
-
-void Timer::run(std::size_t iterations) {
-    intervals_.clear();
-    intervals_.reserve(iterations);
+template class BasicTimer<SystemClock, Milliseconds, SleepSpinWait>;
 
-#ifdef _WIN32
-    TimerResolutionGuard timerGuard(1);
-    BOOL result =
-        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_ABOVE_NORMAL);
-    if (!result) {
-        std::cerr << "Warning: Failed to set thread priority. "
-                  << "Timing precision may be affected.\n";
-    }
-#endif
-
-    startOutputThread();
-
-    lastTimePoint_ = std::chrono::system_clock::now();
-
-    enqueueOutput({OutputData::Type::Start,
-                   ::utils::toMilliseconds(lastTimePoint_), 0.0});
-
-    auto nextHeartbeat =
-        std::chrono::time_point_cast<std::chrono::nanoseconds>(lastTimePoint_);
-
-    auto awakeBeforeHeartbeat =
-        std::min(std::chrono::nanoseconds(10000000), interval_ / 2);
-
-    for (std::size_t i = 0; i < iterations; ++i) {
-        nextHeartbeat += interval_;
-        std::this_thread::sleep_until(nextHeartbeat - awakeBeforeHeartbeat);
-
-        while (std::chrono::system_clock::now() < nextHeartbeat) {
-        }
-
-        auto nowTp = std::chrono::system_clock::now();
-        std::chrono::duration<double, std::milli> diff = nowTp - lastTimePoint_;
-
-        double realInterval = diff.count();
-        intervals_.push_back(realInterval);
-
-        enqueueOutput({OutputData::Type::Interval,
-                       ::utils::toMilliseconds(nowTp), realInterval});
-        lastTimePoint_ = nowTp;
-    }
+void SleepSpinWait::printDetails() const {
+    using Ms = std::chrono::duration<double, std::milli>;
+    using Us = std::chrono::duration<double, std::micro>;
 
-    stopOutputThreadAndJoin();
+    AdaptiveSpinScheduler::Report r = scheduler_.report();
+    double wallMs = Ms(r.sleepTime + r.spinTime).count();
 
-#ifdef _WIN32
-    BOOL restoreResult =
-        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_NORMAL);
-    if (!restoreResult) {
-        std::cerr << "Warning: Failed to restore thread priority.\n";
+    logger << "Spin margin (" << (r.adaptive ? "adaptive" : "fixed")
+           << ", us): " << Us(r.finalMargin).count();
+    if (r.adaptive) {
+        logger << " (p99 oversleep " << Us(r.p99Oversleep).count() << " us)";
     }
-#endif
+    logger << "\n"
+           << "Spin policy: " << spin_.describe() << "\n"
+           << "Missed wake-ups: " << r.missedWakeups << " / " << r.wakeups
+           << "\n"
+           << "Time sleeping (ms): " << Ms(r.sleepTime).count() << "\n"
+           << "Time spinning (ms): " << Ms(r.spinTime).count() << " ("
+           << (wallMs > 0 ? 100.0 * Ms(r.spinTime).count() / wallMs : 0.0)
+           << "% of loop time)\n"
+           << "Timing thread CPU time (ms): " << Ms(r.cpuTime).count() << "\n";
 }
 
 }  // namespace ts
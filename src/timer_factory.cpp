@@ -0,0 +1,57 @@
+#include "timer_factory.hpp"
+
+#include <chrono>
+
+namespace ts {
+
+bool usesHighResTimer(const Options& options) {
+    switch (options.timerKind) {
+    case TimerKind::Timer:
+        return false;
+    case TimerKind::HighRes:
+        return true;
+    case TimerKind::Auto:
+        break;
+    }
+    return options.intervalSec < kHighResThresholdSec;
+}
+
+AnyTimer createTimer(const Options& options) {
+    AnyTimer timer;
+    if (usesHighResTimer(options)) {
+        auto busySpinTimer = std::make_unique<HighResTimer>(
+            options.intervalSec, ClockSource(options.clockKind));
+        busySpinTimer->waitStrategy().setSpinPolicy(options.spinPolicy);
+        timer = std::move(busySpinTimer);
+    } else {
+        auto sleepSpinTimer = std::make_unique<Timer>(options.intervalSec);
+        sleepSpinTimer->waitStrategy().setSpinPolicy(options.spinPolicy);
+        if (options.spinMarginSec > 0) {
+            sleepSpinTimer->waitStrategy().setFixedMargin(
+                std::chrono::nanoseconds(
+                    static_cast<long long>(options.spinMarginSec * 1e9)));
+        }
+        timer = std::move(sleepSpinTimer);
+    }
+    BaseTimer& base = baseTimer(timer);
+    base.setRealtimeOptions(options.realtime);
+    base.setCapturePath(options.capturePath);
+    base.setOverrunPolicy(options.overrunPolicy);
+    base.setExcludeCatchUp(options.excludeCatchUp);
+    base.setRunArena(options.arena);
+    if (!options.soakWindows.empty()) {
+        // Days of per-tick lines are of no use; the windows replace them
+        base.setTickOutput(false);
+        base.setSoakWindows(options.soakWindows);
+    }
+    if (!options.liveStatsName.empty()) {
+        // timer-top shows the ticks instead of the console
+        base.setTickOutput(false);
+        base.setLiveStats(options.liveStatsName,
+                          std::chrono::nanoseconds(static_cast<long long>(
+                              options.liveWindowSec * 1e9)));
+    }
+    return timer;
+}
+
+}  // namespace ts
@@ -0,0 +1,335 @@
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "live_stats.hpp"
+#include "utils.hpp"
+
+namespace {
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+extern "C" void requestStop(int) {
+    stopRequested = 1;
+}
+
+void printUsage(const char* programName) {
+    std::cerr << "Usage: " << programName
+              << " <segment>... [--refresh <seconds>] [--openmetrics]\n"
+              << "       [--openmetrics-file <file>]\n"
+              << "  Shows the live statistics that timer --live-stats "
+                 "publishes, refreshed until Ctrl-C\n"
+              << "  --refresh <seconds>        Refresh period (default: 1)\n"
+              << "  --openmetrics              Print the statistics once as "
+                 "OpenMetrics text and exit\n"
+              << "  --openmetrics-file <file>  Rewrite file as OpenMetrics "
+                 "text every refresh instead\n"
+              << "                             of showing the dashboard\n";
+}
+
+/**
+ * @brief One watched segment, reattached whenever its timer is not running
+ * so that a timer restarted under the same name is picked up
+ */
+struct Source {
+    std::string name;
+    std::unique_ptr<ts::LiveStatsReader> reader;
+    std::string error;
+    ts::LiveStats stats{};
+    bool valid = false;
+
+    // Previous sample, for the tick rate
+    std::uint64_t previousCount = 0;
+    std::chrono::steady_clock::time_point previousTime;
+    double rate = 0.0;
+
+    void refresh() {
+        if (!reader || !valid || stats.running == 0) {
+            try {
+                reader = std::make_unique<ts::LiveStatsReader>(name);
+                error.clear();
+            } catch (const std::exception& e) {
+                // Keep the last statistics of a timer that has exited
+                if (!reader) {
+                    error = e.what();
+                    return;
+                }
+            }
+        }
+
+        ts::LiveStats next;
+        if (!reader->read(next)) {
+            return;  // Shown with the previous values
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (valid && next.count >= previousCount) {
+            double seconds =
+                std::chrono::duration<double>(now - previousTime).count();
+            rate = seconds > 0
+                       ? static_cast<double>(next.count - previousCount) /
+                             seconds
+                       : 0.0;
+        } else {
+            rate = 0.0;
+        }
+        stats         = next;
+        valid         = true;
+        previousCount = next.count;
+        previousTime  = now;
+    }
+};
+
+std::string field(const char* text, std::size_t size) {
+    return std::string(text, strnlen(text, size));
+}
+
+double microseconds(std::int64_t ns) {
+    return static_cast<double>(ns) / 1e3;
+}
+
+double seconds(std::int64_t ns) {
+    return static_cast<double>(ns) / 1e9;
+}
+
+void printDashboard(const std::vector<Source>& sources, std::ostream& out) {
+    // Home the cursor and clear the screen
+    out << "\x1b[H\x1b[2J"
+        << "timer-top: " << sources.size() << " segment(s), times in us\n\n"
+        << std::left << std::setw(20) << "segment" << std::right
+        << std::setw(8) << "pid" << std::setw(9) << "state" << std::setw(12)
+        << "count" << std::setw(10) << "ticks/s" << std::setw(11) << "target"
+        << std::setw(11) << "last" << std::setw(10) << "late"
+        << std::setw(10) << "max late" << std::setw(11) << "p50"
+        << std::setw(11) << "p99" << std::setw(11) << "p99.9"
+        << std::setw(11) << "max" << "\n";
+
+    out << std::fixed << std::setprecision(1);
+    for (const Source& source : sources) {
+        out << std::left << std::setw(20) << source.name << std::right;
+        if (!source.valid) {
+            out << "  " << source.error << "\n";
+            continue;
+        }
+        const ts::LiveStats& s = source.stats;
+        out << std::setw(8) << source.reader->pid() << std::setw(9)
+            << (s.running ? "running" : "done") << std::setw(12) << s.count
+            << std::setw(10) << source.rate << std::setw(11)
+            << microseconds(s.intervalNs) << std::setw(11)
+            << microseconds(s.lastIntervalNs) << std::setw(10)
+            << microseconds(s.lastLatenessNs) << std::setw(10)
+            << microseconds(s.maxLatenessNs) << std::setw(11)
+            << microseconds(s.windowP50Ns) << std::setw(11)
+            << microseconds(s.windowP99Ns) << std::setw(11)
+            << microseconds(s.windowP999Ns) << std::setw(11)
+            << microseconds(s.windowMaxNs) << "\n";
+    }
+    out << "\nPercentiles and max cover the last "
+        << "rolling window of each timer; Ctrl-C quits\n";
+    out.flush();
+}
+
+// Label values escape backslashes, quotes and newlines
+std::string labelValue(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void writeOpenMetrics(const std::vector<Source>& sources, std::ostream& out) {
+    struct Gauge {
+        const char* name;
+        const char* help;
+        std::int64_t ts::LiveStats::*field;
+    };
+    static constexpr Gauge kGauges[] = {
+        {"timer_target_interval_seconds", "Target interval.",
+         &ts::LiveStats::intervalNs},
+        {"timer_last_interval_seconds", "Last measured interval.",
+         &ts::LiveStats::lastIntervalNs},
+        {"timer_last_lateness_seconds",
+         "Lateness of the last tick against its deadline.",
+         &ts::LiveStats::lastLatenessNs},
+        {"timer_max_lateness_seconds", "Largest tick lateness of the run.",
+         &ts::LiveStats::maxLatenessNs},
+        {"timer_window_seconds", "Length of the rolling percentile window.",
+         &ts::LiveStats::windowNs},
+        {"timer_window_max_interval_seconds",
+         "Largest interval in the rolling window.",
+         &ts::LiveStats::windowMaxNs},
+    };
+
+    std::vector<std::pair<std::string, const ts::LiveStats*>> live;
+    for (const Source& source : sources) {
+        if (source.valid) {
+            std::string name = source.name[0] == '/' ? source.name.substr(1)
+                                                     : source.name;
+            std::string labels =
+                "segment=\"" + labelValue(name) + "\",clock=\"" +
+                labelValue(field(source.stats.clockSource,
+                                 sizeof(source.stats.clockSource))) +
+                "\"";
+            live.emplace_back(labels, &source.stats);
+        }
+    }
+
+    out << std::setprecision(9);
+    out << "# TYPE timer_running gauge\n"
+        << "# HELP timer_running Whether the timer is in its run loop.\n";
+    for (const auto& [labels, s] : live) {
+        out << "timer_running{" << labels << "} " << s->running << "\n";
+    }
+    out << "# TYPE timer_intervals counter\n"
+        << "# HELP timer_intervals Intervals measured in the current run.\n";
+    for (const auto& [labels, s] : live) {
+        out << "timer_intervals_total{" << labels << "} " << s->count << "\n";
+    }
+    for (const Gauge& gauge : kGauges) {
+        out << "# TYPE " << gauge.name << " gauge\n"
+            << "# UNIT " << gauge.name << " seconds\n"
+            << "# HELP " << gauge.name << " " << gauge.help << "\n";
+        for (const auto& [labels, s] : live) {
+            out << gauge.name << "{" << labels << "} "
+                << seconds(s->*gauge.field) << "\n";
+        }
+    }
+    out << "# TYPE timer_window_interval_seconds summary\n"
+        << "# UNIT timer_window_interval_seconds seconds\n"
+        << "# HELP timer_window_interval_seconds Interval quantiles over the "
+           "rolling window.\n";
+    for (const auto& [labels, s] : live) {
+        const std::pair<const char*, std::int64_t> quantiles[] = {
+            {"0.5", s->windowP50Ns},
+            {"0.99", s->windowP99Ns},
+            {"0.999", s->windowP999Ns}};
+        for (const auto& [quantile, ns] : quantiles) {
+            out << "timer_window_interval_seconds{" << labels
+                << ",quantile=\"" << quantile << "\"} " << seconds(ns)
+                << "\n";
+        }
+        out << "timer_window_interval_seconds_count{" << labels << "} "
+            << s->windowCount << "\n";
+    }
+    out << "# EOF\n";
+}
+
+// Readers of the file never see a partial exposition
+void replaceFile(const std::string& path, const std::vector<Source>& sources) {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary);
+        writeOpenMetrics(sources, out);
+        if (!out) {
+            throw std::runtime_error("Failed to write " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace " + path + " (" +
+                                 std::strerror(errno) + ")");
+    }
+}
+
+}  // anonymous namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<Source> sources;
+    double refreshSec = 1.0;
+    bool openMetrics  = false;
+    std::string openMetricsPath;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value      = [&]() -> const char* {
+                if (i + 1 >= argc) {
+                    throw std::invalid_argument("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--refresh") {
+                refreshSec = ::utils::parseInterval(value());
+            } else if (arg == "--openmetrics") {
+                openMetrics = true;
+            } else if (arg == "--openmetrics-file") {
+                openMetricsPath = value();
+            } else if (arg.rfind("--", 0) == 0) {
+                throw std::invalid_argument("Unknown option: " + arg);
+            } else {
+                Source source;
+                source.name = arg;
+                sources.push_back(std::move(source));
+            }
+        }
+        if (sources.empty()) {
+            throw std::invalid_argument("Missing segment name");
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        if (openMetrics) {
+            bool any = false;
+            for (Source& source : sources) {
+                source.refresh();
+                if (!source.valid) {
+                    std::cerr << "Warning: " << source.error << "\n";
+                }
+                any = any || source.valid;
+            }
+            writeOpenMetrics(sources, std::cout);
+            return any ? 0 : 1;
+        }
+
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        const auto refresh = std::chrono::duration<double>(refreshSec);
+        auto next          = std::chrono::steady_clock::now();
+        while (!stopRequested) {
+            for (Source& source : sources) {
+                source.refresh();
+            }
+            if (openMetricsPath.empty()) {
+                printDashboard(sources, std::cout);
+            } else {
+                replaceFile(openMetricsPath, sources);
+            }
+
+            // Short sleeps, so that Ctrl-C is handled promptly
+            next += std::chrono::duration_cast<
+                std::chrono::steady_clock::duration>(refresh);
+            while (!stopRequested &&
+                   std::chrono::steady_clock::now() < next) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,422 @@
+#include "timing_wheel.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+#include <utility>
+
+#include "logger.hpp"
+#include "realtime.hpp"
+
+namespace ts {
+
+namespace {
+
+// Per-entry lateness histograms track up to 10s
+constexpr std::uint64_t kLatenessRange = 10ULL * 1000000000ULL;
+
+std::int64_t toNs(TimingWheel::Clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               tp.time_since_epoch())
+        .count();
+}
+
+TimingWheel::Clock::time_point fromNs(std::int64_t ns) {
+    return TimingWheel::Clock::time_point(
+        std::chrono::duration_cast<TimingWheel::Clock::duration>(
+            std::chrono::nanoseconds(ns)));
+}
+
+}  // anonymous namespace
+
+TimingWheel::Entry::Entry(int histogramBits)
+    : lateness(kLatenessRange, histogramBits) {}
+
+TimingWheel::TimingWheel(std::chrono::nanoseconds resolution,
+                         std::size_t capacity, int histogramBits)
+    : resolutionNs_(resolution.count()),
+      originNs_(toNs(Clock::now())),
+      // Wake-ups are at least one tick apart, so the margin is capped at
+      // half a tick to leave room for a sleep
+      scheduler_(resolution) {
+    if (resolutionNs_ <= 0) {
+        throw std::invalid_argument("Timing wheel resolution must be positive");
+    }
+    if (capacity == 0 || capacity >= kNone) {
+        throw std::invalid_argument("Invalid timing wheel capacity");
+    }
+
+    heads_.fill(kNone);
+    entries_.reserve(capacity);
+    freeList_.reserve(capacity);
+    for (std::size_t i = 0; i < capacity; ++i) {
+        entries_.emplace_back(histogramBits);
+    }
+    // Pop order hands out low indices first
+    for (std::size_t i = capacity; i > 0; --i) {
+        freeList_.push_back(static_cast<std::uint32_t>(i - 1));
+    }
+}
+
+TimingWheel::TimerId TimingWheel::schedulePeriodic(
+    Clock::time_point firstDeadline, std::chrono::nanoseconds period,
+    Callback callback) {
+    if (period.count() <= 0) {
+        throw std::invalid_argument("Period must be positive");
+    }
+    return schedule(firstDeadline, period, std::move(callback));
+}
+
+TimingWheel::TimerId TimingWheel::scheduleOnce(Clock::time_point deadline,
+                                               Callback callback) {
+    return schedule(deadline, std::chrono::nanoseconds(0),
+                    std::move(callback));
+}
+
+TimingWheel::TimerId TimingWheel::schedule(Clock::time_point deadline,
+                                           std::chrono::nanoseconds period,
+                                           Callback callback) {
+    if (freeList_.empty()) {
+        throw std::length_error("Timing wheel entry pool exhausted");
+    }
+    std::uint32_t index = freeList_.back();
+    freeList_.pop_back();
+
+    Entry& e      = entries_[index];
+    e.deadlineNs  = toNs(deadline);
+    e.periodNs    = period.count();
+    e.expiresTick = tickFor(e.deadlineNs);
+    e.active      = true;
+    e.callback    = std::move(callback);
+    e.lateness.reset();
+    ++activeCount_;
+
+    place(index);
+    return (static_cast<TimerId>(e.generation) << 32) | index;
+}
+
+bool TimingWheel::cancel(TimerId id) {
+    Entry* e = lookup(id);
+    if (e == nullptr || !e->active) {
+        return false;
+    }
+    std::uint32_t index = static_cast<std::uint32_t>(id & 0xffffffffu);
+    unlink(index);
+    release(index);
+    return true;
+}
+
+std::uint64_t TimingWheel::tickFor(std::int64_t deadlineNs) const {
+    std::int64_t offset = deadlineNs - originNs_;
+    std::uint64_t tick =
+        offset <= 0 ? 0
+                    : static_cast<std::uint64_t>(
+                          (offset + resolutionNs_ - 1) / resolutionNs_);
+    // Never schedule into a tick that has already been processed
+    return std::max(tick, currentTick_ + 1);
+}
+
+std::int64_t TimingWheel::tickTimeNs(std::uint64_t tick) const {
+    return originNs_ + static_cast<std::int64_t>(tick) * resolutionNs_;
+}
+
+void TimingWheel::place(std::uint32_t index) {
+    Entry& e = entries_[index];
+
+    // The top level wraps after 2^32 ticks; park anything further out at the
+    // far edge. expiresTick keeps the real target, so the next cascade
+    // re-places the entry correctly.
+    constexpr std::uint64_t kSpan = 1ULL << (kSlotBits * kLevels);
+    std::uint64_t delta = std::min(e.expiresTick - currentTick_, kSpan - 1);
+    std::uint64_t tick  = currentTick_ + delta;
+
+    int level = 0;
+    while (level < kLevels - 1 &&
+           delta >= (1ULL << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    std::uint32_t slot = static_cast<std::uint32_t>(
+        (tick >> (kSlotBits * level)) & (kSlots - 1));
+    std::uint32_t list = static_cast<std::uint32_t>(level) * kSlots + slot;
+
+    e.list = list;
+    e.prev = kNone;
+    e.next = heads_[list];
+    if (e.next != kNone) {
+        entries_[e.next].prev = index;
+    }
+    heads_[list] = index;
+}
+
+void TimingWheel::unlink(std::uint32_t index) {
+    Entry& e = entries_[index];
+    if (e.list == kNone) {
+        return;
+    }
+    if (e.prev != kNone) {
+        entries_[e.prev].next = e.next;
+    } else {
+        heads_[e.list] = e.next;
+    }
+    if (e.next != kNone) {
+        entries_[e.next].prev = e.prev;
+    }
+    e.prev = e.next = e.list = kNone;
+}
+
+void TimingWheel::release(std::uint32_t index) {
+    Entry& e = entries_[index];
+    e.active = false;
+    ++e.generation;
+    --activeCount_;
+    // A callback may cancel its own entry; keep the slot (and the callback
+    // object that is still executing) out of the free list until it returns
+    if (index == firing_) {
+        releaseDeferred_ = true;
+    } else {
+        freeList_.push_back(index);
+    }
+}
+
+void TimingWheel::cascade(int level, std::uint32_t slot) {
+    std::uint32_t list  = static_cast<std::uint32_t>(level) * kSlots + slot;
+    std::uint32_t index = heads_[list];
+    heads_[list]        = kNone;
+    while (index != kNone) {
+        std::uint32_t next = entries_[index].next;
+        place(index);
+        index = next;
+    }
+}
+
+void TimingWheel::processTick(std::uint64_t tick) {
+    currentTick_ = tick;
+
+    // Refill level 0 from the coarser levels whenever its index wraps
+    for (int level = 1; level < kLevels; ++level) {
+        if ((tick & ((1ULL << (kSlotBits * level)) - 1)) != 0) {
+            break;
+        }
+        cascade(level, static_cast<std::uint32_t>(
+                           (tick >> (kSlotBits * level)) & (kSlots - 1)));
+    }
+
+    // Entries rescheduled from inside this loop always land in later ticks,
+    // so they can never reappear in this slot
+    std::uint32_t list = static_cast<std::uint32_t>(tick & (kSlots - 1));
+    while (heads_[list] != kNone) {
+        std::uint32_t index = heads_[list];
+        unlink(index);
+        fire(index);
+        if (stopRequested_.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+void TimingWheel::fire(std::uint32_t index) {
+    Entry& e = entries_[index];
+
+    // Measured from the tick, not the deadline: rounding up to the tick is
+    // the wheel's resolution, not dispatcher lateness, and is kept apart
+    std::int64_t tickNs   = tickTimeNs(currentTick_);
+    std::int64_t lateness = toNs(Clock::now()) - tickNs;
+    std::uint64_t value =
+        lateness > 0 ? static_cast<std::uint64_t>(lateness) : 0;
+    e.lateness.record(value);
+    aggregate_.record(value);
+    quantization_.record(static_cast<std::uint64_t>(
+        std::max<std::int64_t>(tickNs - e.deadlineNs, 0)));
+    ++expiries_;
+
+    if (e.periodNs == 0) {
+        // One-shot: retire first so the callback may reuse the slot
+        Callback callback = std::move(e.callback);
+        release(index);
+        callback();
+        return;
+    }
+
+    firing_ = index;
+    e.callback();
+    firing_ = kNone;
+
+    if (releaseDeferred_) {
+        releaseDeferred_ = false;
+        freeList_.push_back(index);
+        return;
+    }
+
+    // Drift-free cadence: the next deadline is derived from the previous
+    // deadline, never from the time the callback actually ran
+    e.deadlineNs += e.periodNs;
+    e.expiresTick = tickFor(e.deadlineNs);
+    place(index);
+}
+
+std::uint64_t TimingWheel::nextWakeTick() const {
+    // Scan level 0 up to its next wrap, where a cascade may be due anyway
+    std::uint64_t wrap = (currentTick_ | (kSlots - 1)) + 1;
+    for (std::uint64_t tick = currentTick_ + 1; tick < wrap; ++tick) {
+        if (heads_[tick & (kSlots - 1)] != kNone) {
+            return tick;
+        }
+    }
+    return wrap;
+}
+
+void TimingWheel::run(Clock::time_point until) {
+    stopRequested_.store(false, std::memory_order_relaxed);
+    scheduler_.begin();
+    const std::int64_t untilNs = toNs(until);
+
+    while (!stopRequested_.load(std::memory_order_relaxed)) {
+        std::uint64_t tick    = nextWakeTick();
+        std::int64_t targetNs = tickTimeNs(tick);
+        if (targetNs > untilNs) {
+            sleepUntilAbsolute(until);
+            break;
+        }
+
+        std::int64_t beforeNs = toNs(Clock::now());
+        if (targetNs > beforeNs) {
+            std::int64_t wakeNs = targetNs - scheduler_.margin().count();
+            const bool slept    = wakeNs > beforeNs;
+            if (slept) {
+                sleepUntilAbsolute(fromNs(wakeNs));
+            }
+            std::int64_t wokeNs = toNs(Clock::now());
+            std::int64_t nowNs  = wokeNs;
+            while (nowNs < targetNs) {
+                spin_.relax(std::chrono::nanoseconds(targetNs - nowNs));
+                nowNs = toNs(Clock::now());
+            }
+            // Without a sleep there is no oversleep to learn from, and the
+            // time past wakeNs would only push the margin up
+            if (slept) {
+                scheduler_.record(
+                    std::chrono::nanoseconds(wokeNs - beforeNs),
+                    std::chrono::nanoseconds(wokeNs - wakeNs),
+                    std::chrono::nanoseconds(nowNs - wokeNs),
+                    wokeNs >= targetNs);
+            }
+        }
+
+        processTick(tick);
+    }
+    scheduler_.end();
+}
+
+TimingWheel::Entry* TimingWheel::lookup(TimerId id) {
+    return const_cast<Entry*>(std::as_const(*this).lookup(id));
+}
+
+const TimingWheel::Entry* TimingWheel::lookup(TimerId id) const {
+    std::uint32_t index      = static_cast<std::uint32_t>(id & 0xffffffffu);
+    std::uint32_t generation = static_cast<std::uint32_t>(id >> 32);
+    if (index >= entries_.size()) {
+        return nullptr;
+    }
+    const Entry& e = entries_[index];
+    // Statistics stay readable after expiry or cancellation until reuse
+    if (e.generation == generation ||
+        (e.generation == generation + 1 && !e.active)) {
+        return &e;
+    }
+    return nullptr;
+}
+
+const LatencyHistogram& TimingWheel::latenessHistogram(TimerId id) const {
+    const Entry* e = lookup(id);
+    if (e == nullptr) {
+        throw std::invalid_argument("Unknown or reused timer id");
+    }
+    return e->lateness;
+}
+
+::utils::TimingStats TimingWheel::latenessStats(
+    TimerId id, double nanosecondsPerUnit) const {
+    return makeTimingStats(latenessHistogram(id), nanosecondsPerUnit);
+}
+
+void runWheelProbes(double intervalSec, std::size_t count,
+                    std::size_t intervals, SpinPolicy spinPolicy) {
+    using namespace std::chrono;
+
+    constexpr int kProbeRates          = 4;
+    constexpr std::size_t kWorstToShow = 10;
+
+    auto interval = nanoseconds(static_cast<long long>(intervalSec * 1e9));
+    // Tick a tenth of the base interval, between 10us and 1ms
+    auto resolution =
+        std::clamp(interval / 10, nanoseconds(10000), nanoseconds(1000000));
+
+    TimingWheel wheel(resolution, count);
+    wheel.setSpinPolicy(spinPolicy);
+    std::vector<TimingWheel::TimerId> ids;
+    std::vector<nanoseconds> periods;
+    ids.reserve(count);
+    periods.reserve(count);
+
+    auto start = TimingWheel::Clock::now() + milliseconds(10);
+    for (std::size_t i = 0; i < count; ++i) {
+        nanoseconds period =
+            interval * static_cast<long long>(1 + i % kProbeRates);
+        // Spread first deadlines over one period so probes do not all land
+        // on the same tick
+        auto phase = period * static_cast<long long>(i) /
+                     static_cast<long long>(count);
+        ids.push_back(wheel.schedulePeriodic(start + phase, period, [] {}));
+        periods.push_back(period);
+    }
+
+    wheel.run(start + interval * static_cast<long long>(intervals));
+
+    std::vector<std::pair<double, std::size_t>> worst;
+    worst.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        worst.emplace_back(
+            static_cast<double>(
+                wheel.latenessHistogram(ids[i]).valueAtPercentile(0.99)),
+            i);
+    }
+    std::size_t shown = std::min(kWorstToShow, worst.size());
+    std::partial_sort(worst.begin(), worst.begin() + shown, worst.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.first > b.first;
+                      });
+
+    ::utils::TimingStats all = makeTimingStats(wheel.aggregateLateness(), 1e3);
+    const LatencyHistogram& quantization = wheel.quantization();
+    AdaptiveSpinScheduler::Report sched = wheel.schedulerReport();
+
+    logger << std::fixed << std::setprecision(2);
+    logger << "\n========== Timing Wheel Lateness (us) ==========\n"
+           << "Probes: " << count << ", tick resolution (us): "
+           << duration<double, std::micro>(resolution).count() << "\n"
+           << "Expiries: " << wheel.expiryCount() << "\n"
+           << "Tick quantization average (us): "
+           << quantization.mean() / 1e3 << "\n"
+           << "Tick quantization max (us): "
+           << static_cast<double>(quantization.max()) / 1e3 << "\n"
+           << "Lateness average (us): " << all.average << "\n"
+           << "Lateness 50th Percentile (us): " << all.p50 << "\n"
+           << "Lateness 99th Percentile (us): " << all.p99 << "\n"
+           << "Lateness 99.9th Percentile (us): " << all.p999 << "\n"
+           << "Lateness 99.99th Percentile (us): " << all.p9999 << "\n"
+           << "Dispatcher time sleeping (ms): "
+           << duration<double, std::milli>(sched.sleepTime).count() << "\n"
+           << "Dispatcher time spinning (ms): "
+           << duration<double, std::milli>(sched.spinTime).count() << "\n"
+           << "Worst probes by p99 lateness:\n";
+    for (std::size_t k = 0; k < shown; ++k) {
+        std::size_t i          = worst[k].second;
+        ::utils::TimingStats s = wheel.latenessStats(ids[i], 1e3);
+        logger << "  probe " << i << " (period "
+               << duration<double, std::micro>(periods[i]).count()
+               << " us): p50 " << s.p50 << ", p99 " << s.p99 << "\n";
+    }
+    logger << "================================================\n";
+}
+
+}  // namespace ts